@@ -11,15 +11,152 @@
 
 #include "stdafx.h"
 #include "core/alloc_func.hpp"
+#include "core/smallvec_type.hpp"
+#include "core/sort_func.hpp"
 #include "tile_cmd.h"
 #include "viewport_func.h"
 
-/** The table/list with animated tiles. */
-TileIndex *_animated_tile_list = NULL;
-/** The number of animated tiles in the current state. */
-uint _animated_tile_count = 0;
-/** The number of slots for animated tiles allocated currently. */
-uint _animated_tile_allocated = 0;
+/**
+ * An animated tile. The tiles are animated in the order they were added,
+ * which is the order of their positions in #_animated_tiles.
+ */
+struct AnimatedTile {
+	TileIndex tile; ///< The tile, or #INVALID_TILE when it has been removed.
+	uint32 due;     ///< The tick the tile is to be animated again when it is sleeping, otherwise 0.
+};
+
+/** A slot of #_animated_tile_hash. */
+struct AnimatedTileHashSlot {
+	TileIndex tile; ///< The tile, or #INVALID_TILE when the slot is free.
+	uint32 pos;     ///< The position of the tile in #_animated_tiles.
+};
+
+static const uint ANIMATED_TILE_WHEEL_SIZE = 256; ///< Number of slots of #_animated_tile_wheel.
+
+/** All animated tiles, including the removed ones. */
+static SmallVector<AnimatedTile, 256> _animated_tiles;
+/** The number of removed tiles in #_animated_tiles. */
+static uint _animated_tile_removed = 0;
+/** Positions in #_animated_tiles of the tiles to animate every tick, in order. */
+static SmallVector<uint32, 256> _animated_tile_active;
+/** Positions in #_animated_tiles of the sleeping tiles, by the tick they are due modulo the size of the wheel. */
+static SmallVector<uint32, 16> _animated_tile_wheel[ANIMATED_TILE_WHEEL_SIZE];
+/** The number of times the animated tiles were animated. */
+static uint32 _animated_tile_tick = 0;
+
+/** Hash table from tiles to their positions in #_animated_tiles. */
+static AnimatedTileHashSlot *_animated_tile_hash = NULL;
+/** The number of slots in #_animated_tile_hash; always a power of two. */
+static uint _animated_tile_hash_size = 0;
+
+/**
+ * Get the slot in the hash table where a tile would be when nothing else was in the way.
+ * @param tile The tile.
+ * @return The index of the slot.
+ */
+static inline uint GetAnimatedTileHomeSlot(TileIndex tile)
+{
+	return (tile * 0x9E3779B1U) >> 8 & (_animated_tile_hash_size - 1);
+}
+
+/**
+ * Get the slot in the hash table where a tile is, or where it would be.
+ * @param tile The tile to look for.
+ * @return The slot; its tile is #INVALID_TILE when the tile is not animated.
+ */
+static AnimatedTileHashSlot *FindAnimatedTileSlot(TileIndex tile)
+{
+	uint mask = _animated_tile_hash_size - 1;
+	uint i = GetAnimatedTileHomeSlot(tile);
+	while (_animated_tile_hash[i].tile != tile && _animated_tile_hash[i].tile != INVALID_TILE) i = (i + 1) & mask;
+	return &_animated_tile_hash[i];
+}
+
+/**
+ * Make the hash table refer to the tiles in #_animated_tiles, after
+ * the tiles have moved or the table has to grow.
+ */
+static void RebuildAnimatedTileHash()
+{
+	uint size = 256;
+	while (size < (_animated_tiles.Length() - _animated_tile_removed) * 2) size *= 2;
+
+	if (size != _animated_tile_hash_size) {
+		free(_animated_tile_hash);
+		_animated_tile_hash = MallocT<AnimatedTileHashSlot>(size);
+		_animated_tile_hash_size = size;
+	}
+	MemSetT(_animated_tile_hash, 0xFF, size);
+
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		TileIndex tile = _animated_tiles[i].tile;
+		if (tile == INVALID_TILE) continue;
+
+		AnimatedTileHashSlot *slot = FindAnimatedTileSlot(tile);
+		slot->tile = tile;
+		slot->pos = i;
+	}
+}
+
+/**
+ * Wake all sleeping tiles and drop the removed ones from #_animated_tiles.
+ * Waking tiles early is always safe; they just check again whether their
+ * next frame is due.
+ */
+static void CompactAnimatedTiles()
+{
+	uint count = 0;
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		if (_animated_tiles[i].tile == INVALID_TILE) continue;
+		_animated_tiles[count].tile = _animated_tiles[i].tile;
+		_animated_tiles[count].due = 0;
+		count++;
+	}
+	/* Shrink to the remaining tiles; appending does not touch them. */
+	_animated_tiles.Clear();
+	_animated_tiles.Append(count);
+	_animated_tile_removed = 0;
+
+	_animated_tile_active.Clear();
+	for (uint i = 0; i < count; i++) *_animated_tile_active.Append() = i;
+	for (uint i = 0; i < ANIMATED_TILE_WHEEL_SIZE; i++) _animated_tile_wheel[i].Clear();
+
+	RebuildAnimatedTileHash();
+}
+
+/**
+ * Add a tile to the animated tiles without marking it dirty.
+ * @param tile The tile to add.
+ * @return True if the tile was not animated yet.
+ */
+static bool InsertAnimatedTile(TileIndex tile)
+{
+	AnimatedTileHashSlot *slot = FindAnimatedTileSlot(tile);
+	if (slot->tile == tile) {
+		/* Wake the tile, in case whatever added it changed its animation. */
+		AnimatedTile *at = &_animated_tiles[slot->pos];
+		if (at->due != 0) {
+			at->due = _animated_tile_tick + 1;
+			*_animated_tile_wheel[at->due % ANIMATED_TILE_WHEEL_SIZE].Append() = slot->pos;
+		}
+		return false;
+	}
+
+	uint32 pos = _animated_tiles.Length();
+	AnimatedTile *at = _animated_tiles.Append();
+	at->tile = tile;
+	at->due = 0;
+	/* It has the highest position, so the active tiles stay in order. */
+	*_animated_tile_active.Append() = pos;
+
+	if ((_animated_tiles.Length() - _animated_tile_removed) * 2 > _animated_tile_hash_size) {
+		RebuildAnimatedTileHash();
+	} else {
+		slot->tile = tile;
+		slot->pos = pos;
+	}
+	return true;
+}
 
 /**
  * Removes the given tile from the animated tile table.
@@ -27,18 +164,28 @@ uint _animated_tile_allocated = 0;
  */
 void DeleteAnimatedTile(TileIndex tile)
 {
-	for (TileIndex *ti = _animated_tile_list; ti < _animated_tile_list + _animated_tile_count; ti++) {
-		if (tile == *ti) {
-			/* Remove the hole
-			 * The order of the remaining elements must stay the same, otherwise the animation loop
-			 * may miss a tile; that's why we must use memmove instead of just moving the last element.
-			 */
-			memmove(ti, ti + 1, (_animated_tile_list + _animated_tile_count - (ti + 1)) * sizeof(*ti));
-			_animated_tile_count--;
-			MarkTileDirtyByTile(tile);
-			return;
+	AnimatedTileHashSlot *slot = FindAnimatedTileSlot(tile);
+	if (slot->tile != tile) return;
+
+	/* Leave a hole, so the order of the remaining tiles stays the same. The
+	 * active list and the wheel skip it, and it is dropped when compacting. */
+	_animated_tiles[slot->pos].tile = INVALID_TILE;
+	_animated_tile_removed++;
+
+	/* Close the gap in the hash table, so the following tiles can still be found. */
+	uint mask = _animated_tile_hash_size - 1;
+	uint i = slot - _animated_tile_hash;
+	for (uint j = (i + 1) & mask; _animated_tile_hash[j].tile != INVALID_TILE; j = (j + 1) & mask) {
+		uint home = GetAnimatedTileHomeSlot(_animated_tile_hash[j].tile);
+		/* Move the entry when its home is not between the hole and it. */
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			_animated_tile_hash[i] = _animated_tile_hash[j];
+			i = j;
 		}
 	}
+	_animated_tile_hash[i].tile = INVALID_TILE;
+
+	MarkTileDirtyByTile(tile);
 }
 
 /**
@@ -49,19 +196,36 @@ void DeleteAnimatedTile(TileIndex tile)
 void AddAnimatedTile(TileIndex tile)
 {
 	MarkTileDirtyByTile(tile);
+	InsertAnimatedTile(tile);
+}
 
-	for (const TileIndex *ti = _animated_tile_list; ti < _animated_tile_list + _animated_tile_count; ti++) {
-		if (tile == *ti) return;
-	}
+/**
+ * Let an animated tile sleep until its next frame is due. It is only valid
+ * to be used when calling AnimateTile earlier would not change anything.
+ * @param tile  The tile that is being animated.
+ * @param ticks The number of ticks until the tile has to be animated again.
+ */
+void SetAnimatedTileDelay(TileIndex tile, uint ticks)
+{
+	if (ticks <= 1) return;
 
-	/* Table not large enough, so make it larger */
-	if (_animated_tile_count == _animated_tile_allocated) {
-		_animated_tile_allocated *= 2;
-		_animated_tile_list = ReallocT<TileIndex>(_animated_tile_list, _animated_tile_allocated);
-	}
+	AnimatedTileHashSlot *slot = FindAnimatedTileSlot(tile);
+	if (slot->tile != tile) return;
+
+	AnimatedTile *at = &_animated_tiles[slot->pos];
+	at->due = _animated_tile_tick + ticks;
+	*_animated_tile_wheel[at->due % ANIMATED_TILE_WHEEL_SIZE].Append() = slot->pos;
+}
 
-	_animated_tile_list[_animated_tile_count] = tile;
-	_animated_tile_count++;
+/**
+ * Compare two positions in #_animated_tiles.
+ * @param a The first position.
+ * @param b The second position.
+ * @return Less than, equal to or more than zero when \a a is before, at or after \a b.
+ */
+static int CDECL AnimatedTilePositionSorter(const uint32 *a, const uint32 *b)
+{
+	return (*a > *b) - (*a < *b);
 }
 
 /**
@@ -69,21 +233,80 @@ void AddAnimatedTile(TileIndex tile)
  */
 void AnimateAnimatedTiles()
 {
-	const TileIndex *ti = _animated_tile_list;
-	while (ti < _animated_tile_list + _animated_tile_count) {
-		const TileIndex curr = *ti;
-		AnimateTile(curr);
-		/* During the AnimateTile call, DeleteAnimatedTile could have been called,
-		 * deleting an element we've already processed and pushing the rest one
-		 * slot to the left. We can detect this by checking whether the index
-		 * in the current slot has changed - if it has, an element has been deleted,
-		 * and we should process the current slot again instead of going forward.
-		 * NOTE: this will still break if more than one animated tile is being
-		 *       deleted during the same AnimateTile call, but no code seems to
-		 *       be doing this anyway.
-		 */
-		if (*ti == curr) ++ti;
+	_animated_tile_tick++;
+
+	/* Wake the tiles that are due this tick. */
+	static SmallVector<uint32, 64> woken;
+	woken.Clear();
+	SmallVector<uint32, 16> &slot = _animated_tile_wheel[_animated_tile_tick % ANIMATED_TILE_WHEEL_SIZE];
+	for (uint i = 0; i < slot.Length(); /* nothing */) {
+		AnimatedTile *at = &_animated_tiles[slot[i]];
+		if (at->tile != INVALID_TILE && at->due != 0 && at->due != _animated_tile_tick) {
+			/* Not this time around the wheel yet. */
+			i++;
+			continue;
+		}
+		if (at->tile != INVALID_TILE && at->due == _animated_tile_tick) {
+			at->due = 0;
+			*woken.Append() = slot[i];
+		}
+		slot.Erase(slot.Get(i));
 	}
+
+	/* Merge them with the awake tiles, so all are animated in the order they were added. */
+	static SmallVector<uint32, 256> active;
+	active.Clear();
+	if (woken.Length() > 1) QSortT(woken.Begin(), woken.Length(), &AnimatedTilePositionSorter);
+	const uint32 *w = woken.Begin();
+	for (const uint32 *a = _animated_tile_active.Begin(); a != _animated_tile_active.End(); a++) {
+		const AnimatedTile &at = _animated_tiles[*a];
+		if (at.tile == INVALID_TILE || at.due != 0) continue;
+		while (w != woken.End() && *w < *a) *active.Append() = *w++;
+		*active.Append() = *a;
+	}
+	while (w != woken.End()) *active.Append() = *w++;
+	_animated_tile_active.Clear();
+	MemCpyT(_animated_tile_active.Append(active.Length()), active.Begin(), active.Length());
+
+	/* Tiles added while animating are appended, and animated this tick too. */
+	for (uint i = 0; i < _animated_tile_active.Length(); i++) {
+		const AnimatedTile &at = _animated_tiles[_animated_tile_active[i]];
+		if (at.tile == INVALID_TILE || at.due != 0) continue;
+		AnimateTile(at.tile);
+	}
+
+	if (_animated_tile_removed > 256 && _animated_tile_removed * 2 > _animated_tiles.Length()) CompactAnimatedTiles();
+}
+
+/**
+ * Wake all sleeping animated tiles; needed when their animation
+ * speed may have changed, e.g. when the NewGRFs are reloaded.
+ */
+void WakeAnimatedTiles()
+{
+	CompactAnimatedTiles();
+}
+
+/**
+ * Get all animated tiles, in the order they are animated.
+ * @param[out] tiles Where to store the tiles.
+ */
+void GetAnimatedTiles(SmallVector<TileIndex, 256> *tiles)
+{
+	tiles->Clear();
+	for (const AnimatedTile *at = _animated_tiles.Begin(); at != _animated_tiles.End(); at++) {
+		if (at->tile != INVALID_TILE) *tiles->Append() = at->tile;
+	}
+}
+
+/**
+ * Add a tile to the end of the animated tiles, without touching the
+ * viewports; for loading savegames.
+ * @param tile The tile to add.
+ */
+void AppendAnimatedTile(TileIndex tile)
+{
+	InsertAnimatedTile(tile);
 }
 
 /**
@@ -91,7 +314,7 @@ void AnimateAnimatedTiles()
  */
 void InitializeAnimatedTiles()
 {
-	_animated_tile_list = ReallocT<TileIndex>(_animated_tile_list, 256);
-	_animated_tile_count = 0;
-	_animated_tile_allocated = 256;
+	_animated_tiles.Clear();
+	_animated_tile_removed = 0;
+	CompactAnimatedTiles();
 }
@@ -16,6 +16,8 @@
 
 void AddAnimatedTile(TileIndex tile);
 void DeleteAnimatedTile(TileIndex tile);
+void SetAnimatedTileDelay(TileIndex tile, uint ticks);
+void WakeAnimatedTiles();
 void AnimateAnimatedTiles();
 void InitializeAnimatedTiles();
 
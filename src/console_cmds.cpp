@@ -37,6 +37,10 @@
 #include "newgrf.h"
 #include "console_func.h"
 #include "engine_base.h"
+#include "spritecache.h"
+#include "gfx_func.h"
+#include "mixer.h"
+#include "sound_func.h"
 
 #ifdef ENABLE_NETWORK
 	#include "table/strings.h"
@@ -1274,6 +1278,118 @@ DEF_CONSOLE_CMD(ConRescanNewGRF)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConBenchmarkSprites)
+{
+	if (argc == 0) {
+		IConsoleHelp("Read all sprites from disk, both memory mapped and buffered, and show the time it takes. Usage: 'benchmark_sprites'");
+		return true;
+	}
+
+	/* Warm up the page cache first, then run both modes twice in alternating
+	 * order, so neither of them profits from the other having run before it. */
+	static const bool passes[] = { true, false, false, true };
+
+	ReadAllSprites();
+
+	uint count = 0;
+	uint64 cycles[2] = { 0, 0 };
+	for (uint i = 0; i < lengthof(passes); i++) {
+		FioSetMemoryMapping(passes[i]);
+
+		uint64 start = ottd_rdtsc();
+		count = ReadAllSprites();
+		cycles[passes[i]] += ottd_rdtsc() - start;
+	}
+	FioSetMemoryMapping(true);
+
+	IConsolePrintF(CC_DEFAULT, "Memory mapped: read %u sprites in " OTTD_PRINTF64 " cycles on average", count, cycles[1] / 2);
+	IConsolePrintF(CC_DEFAULT, "Buffered: read %u sprites in " OTTD_PRINTF64 " cycles on average", count, cycles[0] / 2);
+
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConTextCacheStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show how often drawn strings were found in the text cache. Usage: 'textcache_stats'");
+		return true;
+	}
+
+	uint entries, hits, misses;
+	GetTextRunCacheStats(&entries, &hits, &misses);
+	uint total = hits + misses;
+	IConsolePrintF(CC_DEFAULT, "Text cache: %u entries, %u hits, %u misses (%u%% hit rate)", entries, hits, misses, total == 0 ? 0 : (uint)((uint64)hits * 100 / total));
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConMixerBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Measure how long mixing one second of sound takes. Usage: 'mixer_benchmark [<channels>]'");
+		IConsoleHelp("The number of channels defaults to 32, the maximum.");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint32 channels = 32;
+	if (argc == 2 && !GetArgumentInteger(&channels, argv[1])) return false;
+
+	IConsolePrintF(CC_DEFAULT, "Mixing one second of %u sounds took " OTTD_PRINTF64 " CPU ticks", channels, MxBenchmark(channels));
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConSoundCullStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show how often running sounds of vehicles were skipped because no viewport shows the vehicle. Usage: 'soundcull_stats'");
+		return true;
+	}
+
+	uint checked, culled;
+	GetVehicleSoundCullStats(&checked, &culled);
+	IConsolePrintF(CC_DEFAULT, "Vehicle sounds: %u checked, %u skipped (%u%%)", checked, culled, checked == 0 ? 0 : (uint)((uint64)culled * 100 / checked));
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConTileLoopStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the work done by the tile loop per tile type. Usage: 'tileloop_stats [on | off | reset]'");
+		IConsoleHelp("'on' and 'off' start and stop measuring the time spent, 'reset' clears the statistics.");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "on") == 0) {
+			_tile_loop_profiling = true;
+		} else if (strcmp(argv[1], "off") == 0) {
+			_tile_loop_profiling = false;
+		} else if (strcmp(argv[1], "reset") == 0) {
+			ResetTileLoopStats();
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	static const char * const type_names[] = {
+		"clear", "railway", "road", "house", "trees", "station",
+		"water", "void", "industry", "tunnel/bridge", "object",
+	};
+
+	for (uint type = 0; type < lengthof(type_names); type++) {
+		const TileLoopStats *stats = GetTileLoopStats((TileType)type);
+		if (stats->tiles == 0) continue;
+		IConsolePrintF(CC_DEFAULT, "%-14s " OTTD_PRINTF64 " tiles, " OTTD_PRINTF64 " CPU ticks, " OTTD_PRINTF64 " per tile",
+				type_names[type], stats->tiles, stats->cycles, stats->cycles / stats->tiles);
+	}
+	if (!_tile_loop_profiling) IConsolePrint(CC_DEFAULT, "Time is not being measured; use 'tileloop_stats on' to start measuring.");
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConGetSeed)
 {
 	if (argc == 0) {
@@ -1887,6 +2003,11 @@ void IConsoleStdLibRegister()
 	IConsoleCmdRegister("list_settings",ConListSettings);
 	IConsoleCmdRegister("gamelog",      ConGamelogPrint);
 	IConsoleCmdRegister("rescan_newgrf", ConRescanNewGRF);
+	IConsoleCmdRegister("benchmark_sprites", ConBenchmarkSprites);
+	IConsoleCmdRegister("textcache_stats", ConTextCacheStats);
+	IConsoleCmdRegister("mixer_benchmark", ConMixerBenchmark);
+	IConsoleCmdRegister("soundcull_stats", ConSoundCullStats);
+	IConsoleCmdRegister("tileloop_stats", ConTileLoopStats);
 
 	IConsoleAliasRegister("dir",          "ls");
 	IConsoleAliasRegister("del",          "rm %+");
@@ -12,6 +12,7 @@
 #ifndef SORT_FUNC_HPP
 #define SORT_FUNC_HPP
 
+#include "alloc_func.hpp"
 #include "mem_func.hpp"
 
 /**
@@ -86,4 +87,79 @@ static inline void GSortT(T *base, uint num, int (CDECL *comparator)(const T*, c
 	}
 }
 
+/**
+ * Check whether an element has to go strictly before another one.
+ * @param a The first element.
+ * @param b The second element.
+ * @param comparator Function that compares two elements.
+ * @param desc Sort descending.
+ * @return True if \a a goes before \a b.
+ */
+template <typename T>
+static FORCEINLINE bool MSortBefore(const T *a, const T *b, int (CDECL *comparator)(const T*, const T*), bool desc)
+{
+	const int diff = comparator(a, b);
+	return desc ? diff > 0 : diff < 0;
+}
+
+/**
+ * Type safe natural merge sort.
+ *
+ * Runs of already sorted elements are merged as a whole, so
+ * a sorted list takes a single pass and a list with a few
+ * elements out of place only a few passes. Unlike #GSortT
+ * it never needs more than O(n log n) comparisons.
+ *
+ * @note Use this sort for presorted / regular sorted data.
+ * @note The sort is stable, also when sorting descending.
+ *
+ * @param base Pointer to the first element of the array to be sorted.
+ * @param num Number of elements in the array pointed by base.
+ * @param comparator Function that compares two elements.
+ * @param desc Sort descending.
+ */
+template <typename T>
+static inline void MSortT(T *base, uint num, int (CDECL *comparator)(const T*, const T*), bool desc = false)
+{
+	if (num < 2) return;
+
+	assert(base != NULL);
+	assert(comparator != NULL);
+
+	T *buffer = MallocT<T>(num);
+	T *src = base;
+	T *dst = buffer;
+
+	for (;;) {
+		uint runs = 0;
+
+		for (uint start = 0; start < num; runs++) {
+			/* Find two consecutive runs: [start, mid) and [mid, end). */
+			uint mid = start + 1;
+			while (mid < num && !MSortBefore(src + mid, src + mid - 1, comparator, desc)) mid++;
+			uint end = mid;
+			if (end < num) {
+				end++;
+				while (end < num && !MSortBefore(src + end, src + end - 1, comparator, desc)) end++;
+			}
+
+			/* Merge them; on equal elements the first run goes first. */
+			uint i = start;
+			uint j = mid;
+			uint k = start;
+			while (i < mid && j < end) dst[k++] = MSortBefore(src + j, src + i, comparator, desc) ? src[j++] : src[i++];
+			while (i < mid) dst[k++] = src[i++];
+			while (j < end) dst[k++] = src[j++];
+
+			start = end;
+		}
+
+		Swap(src, dst);
+		if (runs == 1) break;
+	}
+
+	if (src != base) MemCpyT(base, src, num);
+	free(buffer);
+}
+
 #endif /* SORT_FUNC_HPP */
@@ -30,6 +30,12 @@
 #include <sys/stat.h>
 #include <algorithm>
 
+#if defined(UNIX) && !defined(__MORPHOS__) && !defined(__AMIGA__) && !defined(__OS2__) && !defined(DOS)
+/* Read the data files through memory mappings instead of stdio where possible. */
+#	define WITH_MMAP
+#	include <sys/mman.h>
+#endif
+
 /*************************************************/
 /* FILE IO ROUTINES ******************************/
 /*************************************************/
@@ -37,13 +43,22 @@
 /** Size of the #Fio data buffer. */
 #define FIO_BUFFER_SIZE 512
 
-/** Structure for keeping several open files with just one data buffer. */
+/**
+ * Structure for keeping several open files with just one data buffer.
+ * When a file is memory mapped, #buffer and #buffer_end point into the mapping
+ * of the whole file instead of #buffer_start, so reading never needs a refill.
+ */
 struct Fio {
 	byte *buffer, *buffer_end;             ///< position pointer in local buffer and last valid byte of buffer
 	size_t pos;                            ///< current (system) position in file
 	FILE *cur_fh;                          ///< current file handle
 	const char *filename;                  ///< current filename
+	byte *map_base;                        ///< start of the memory mapping of the current file, or \c NULL when reading through #buffer_start
 	FILE *handles[MAX_FILE_SLOTS];         ///< array of file handles we can have open
+#if defined(WITH_MMAP)
+	byte *mapped[MAX_FILE_SLOTS];          ///< memory mapping of the whole file of each slot, or \c NULL when it could not be mapped
+	size_t mapped_size[MAX_FILE_SLOTS];    ///< size of the memory mapping of each slot
+#endif /* WITH_MMAP */
 	byte buffer_start[FIO_BUFFER_SIZE];    ///< local buffer when read from file
 	const char *filenames[MAX_FILE_SLOTS]; ///< array of filenames we (should) have open
 	char *shortnames[MAX_FILE_SLOTS];      ///< array of short names for spriteloader's use
@@ -55,6 +70,9 @@ struct Fio {
 
 static Fio _fio; ///< #Fio instance.
 
+/** Whether to read memory mapped files through their mapping. */
+static bool _fio_use_mmap = true;
+
 /** Whether the working directory should be scanned. */
 static bool _do_scan_working_directory = true;
 
@@ -80,6 +98,11 @@ const char *FioGetFilename(uint8 slot)
 void FioSeekTo(size_t pos, int mode)
 {
 	if (mode == SEEK_CUR) pos += FioGetPos();
+	if (_fio.map_base != NULL) {
+		/* Everything beyond the end of the mapping behaves as the end of the file. */
+		_fio.buffer = _fio.map_base + min(pos, _fio.pos);
+		return;
+	}
 	_fio.buffer = _fio.buffer_end = _fio.buffer_start + FIO_BUFFER_SIZE;
 	_fio.pos = pos;
 	fseek(_fio.cur_fh, _fio.pos, SEEK_SET);
@@ -109,12 +132,24 @@ void FioSeekToFile(uint8 slot, size_t pos)
 	assert(f != NULL);
 	_fio.cur_fh = f;
 	_fio.filename = _fio.filenames[slot];
+	_fio.map_base = NULL;
+#if defined(WITH_MMAP)
+	if (_fio_use_mmap && _fio.mapped[slot] != NULL) {
+		/* The 'system' position is the end of the mapping, so FioGetPos() keeps working. */
+		_fio.map_base = _fio.mapped[slot];
+		_fio.pos = _fio.mapped_size[slot];
+		_fio.buffer_end = _fio.map_base + _fio.mapped_size[slot];
+	}
+#endif /* WITH_MMAP */
 	FioSeekTo(pos, SEEK_SET);
 }
 
 byte FioReadByte()
 {
 	if (_fio.buffer == _fio.buffer_end) {
+		/* A mapping contains the whole file, so there is nothing left to read. */
+		if (_fio.map_base != NULL) return 0;
+
 		_fio.buffer = _fio.buffer_start;
 		size_t size = fread(_fio.buffer, 1, FIO_BUFFER_SIZE, _fio.cur_fh);
 		_fio.pos += size;
@@ -151,13 +186,81 @@ uint32 FioReadDword()
 
 void FioReadBlock(void *ptr, size_t size)
 {
+	if (_fio.map_base != NULL) {
+		size = min<size_t>(size, _fio.buffer_end - _fio.buffer);
+		memcpy(ptr, _fio.buffer, size);
+		_fio.buffer += size;
+		return;
+	}
+
 	FioSeekTo(FioGetPos(), SEEK_SET);
 	_fio.pos += fread(ptr, 1, size, _fio.cur_fh);
 }
 
+/**
+ * Get direct access to the data at the current position in the current file.
+ * This avoids copying the data when the file is memory mapped.
+ * @param size [out] Number of bytes that can be read from the returned pointer.
+ * @return Pointer to the data, or \c NULL when the file has to be read with the other Fio functions.
+ * @note The position in the file is not changed; use #FioSkipBytes to skip the consumed data.
+ */
+const byte *FioGetMappedData(size_t *size)
+{
+	if (_fio.map_base == NULL) return NULL;
+
+	*size = _fio.buffer_end - _fio.buffer;
+	return _fio.buffer;
+}
+
+/**
+ * Select whether memory mapped files are read through their mapping or through the buffered (stdio) path.
+ * @param enable Whether to use the memory mappings.
+ * @note Takes effect at the next #FioSeekToFile.
+ */
+void FioSetMemoryMapping(bool enable)
+{
+	_fio_use_mmap = enable;
+}
+
+#if defined(WITH_MMAP)
+/**
+ * Memory map the whole file of a slot. Files inside tars are read at their offset
+ * in the tar, so the complete (tar) file is mapped. When the file can not be mapped,
+ * it is read through the buffered path.
+ * @param slot Slot of the opened file.
+ */
+static void FioMapFile(int slot)
+{
+	int fd = fileno(_fio.handles[slot]);
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) return;
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		DEBUG(misc, 6, "Cannot memory map '%s', falling back to buffered reading", _fio.filenames[slot]);
+		return;
+	}
+
+	_fio.mapped[slot] = (byte *)map;
+	_fio.mapped_size[slot] = st.st_size;
+}
+#endif /* WITH_MMAP */
+
 static inline void FioCloseFile(int slot)
 {
 	if (_fio.handles[slot] != NULL) {
+		if (_fio.cur_fh == _fio.handles[slot]) {
+			/* Nothing may be read from the closed file anymore; also not from its mapping. */
+			_fio.cur_fh = NULL;
+			_fio.map_base = NULL;
+			_fio.buffer = _fio.buffer_end = _fio.buffer_start + FIO_BUFFER_SIZE;
+		}
+#if defined(WITH_MMAP)
+		if (_fio.mapped[slot] != NULL) {
+			munmap(_fio.mapped[slot], _fio.mapped_size[slot]);
+			_fio.mapped[slot] = NULL;
+		}
+#endif /* WITH_MMAP */
 		fclose(_fio.handles[slot]);
 
 		free(_fio.shortnames[slot]);
@@ -215,6 +318,9 @@ void FioOpenFile(int slot, const char *filename)
 	FioCloseFile(slot); // if file was opened before, close it
 	_fio.handles[slot] = f;
 	_fio.filenames[slot] = filename;
+#if defined(WITH_MMAP)
+	FioMapFile(slot);
+#endif /* WITH_MMAP */
 
 	/* Store the filename without path and extension */
 	const char *t = strrchr(filename, PATHSEPCHAR);
@@ -25,6 +25,8 @@ void FioCloseAll();
 void FioOpenFile(int slot, const char *filename);
 void FioReadBlock(void *ptr, size_t size);
 void FioSkipBytes(int n);
+const byte *FioGetMappedData(size_t *size);
+void FioSetMemoryMapping(bool enable);
 
 /**
  * The search paths OpenTTD could search through.
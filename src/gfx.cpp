@@ -421,8 +421,6 @@ static int TruncateString(char *str, int maxw, bool ignore_setxy, FontSize start
 	return w;
 }
 
-static int ReallyDoDrawString(const UChar *string, int x, int y, DrawStringParams &params, bool parse_string_also_when_clipped = false);
-
 /**
  * Get the real width of the string.
  * @param str the string to draw
@@ -461,6 +459,241 @@ static int GetStringWidth(const UChar *str, FontSize start_fontsize)
 	return max(max_width, width);
 }
 
+/** A glyph of a #TextRun. */
+struct TextRunGlyph {
+	int16 x;           ///< Horizontal offset from the start of the run.
+	int16 y;           ///< Vertical offset from the start of the run.
+	WChar c;           ///< The character.
+	FontSize size;     ///< The font of the character.
+	TextColour colour; ///< The colour of the character.
+};
+
+/**
+ * A string that has been decoded and measured for drawing. Strings in lists
+ * and the like are drawn every time the window is redrawn, so the runs of
+ * the most recently drawn strings are kept.
+ */
+struct TextRun {
+	TextRun *hash_next;     ///< Next run in the same bucket of #_text_run_hash.
+	TextRun *lru_prev;      ///< The run that was used just after this one.
+	TextRun *lru_next;      ///< The run that was used just before this one.
+	uint32 hash;            ///< Hash of the text and the start parameters.
+	UChar *text;            ///< The text.
+	uint length;            ///< The number of characters of the text.
+	DrawStringParams start; ///< The parameters the drawing starts with.
+	DrawStringParams end;   ///< The parameters after drawing the text.
+	int width;              ///< The width of the text.
+	int end_x;              ///< Offset of the position after the last character.
+	SmallVector<TextRunGlyph, 16> glyphs; ///< The glyphs to draw.
+
+	/**
+	 * Create a run.
+	 * @param params The parameters the drawing starts with.
+	 */
+	TextRun(const DrawStringParams &params) : start(params), end(params) {}
+
+	/** Free the text. */
+	~TextRun()
+	{
+		free(this->text);
+	}
+};
+
+static const uint TEXT_RUN_HASH_SIZE = 1024; ///< Number of buckets of #_text_run_hash.
+static const uint TEXT_RUN_CACHE_SIZE = 512; ///< Number of runs that are kept.
+
+static TextRun *_text_run_hash[TEXT_RUN_HASH_SIZE]; ///< The cached runs, by hash.
+static TextRun *_text_run_lru_first = NULL;        ///< The most recently used run.
+static TextRun *_text_run_lru_last = NULL;         ///< The least recently used run.
+static uint _text_run_count = 0;                    ///< The number of cached runs.
+static uint _text_run_hits = 0;                     ///< The number of lookups that found a cached run.
+static uint _text_run_misses = 0;                   ///< The number of lookups that had to make a new run.
+
+/**
+ * Remove a run from the list of recently used runs.
+ * @param run The run to remove.
+ */
+static void UnlinkTextRun(TextRun *run)
+{
+	if (run->lru_prev != NULL) run->lru_prev->lru_next = run->lru_next; else _text_run_lru_first = run->lru_next;
+	if (run->lru_next != NULL) run->lru_next->lru_prev = run->lru_prev; else _text_run_lru_last = run->lru_prev;
+}
+
+/**
+ * Make a run the most recently used one.
+ * @param run The run to use.
+ */
+static void LinkTextRunFirst(TextRun *run)
+{
+	run->lru_prev = NULL;
+	run->lru_next = _text_run_lru_first;
+	if (_text_run_lru_first != NULL) _text_run_lru_first->lru_prev = run; else _text_run_lru_last = run;
+	_text_run_lru_first = run;
+}
+
+/** Forget all text runs; needed when the fonts change. */
+static void ClearTextRunCache()
+{
+	for (uint i = 0; i < TEXT_RUN_HASH_SIZE; i++) {
+		TextRun *run = _text_run_hash[i];
+		while (run != NULL) {
+			TextRun *next = run->hash_next;
+			delete run;
+			run = next;
+		}
+		_text_run_hash[i] = NULL;
+	}
+	_text_run_lru_first = NULL;
+	_text_run_lru_last = NULL;
+	_text_run_count = 0;
+}
+
+/**
+ * Decode a text into glyphs and positions, handling the colour, font size and positioning codes in it.
+ * @param run The run to fill; its text and start parameters are set.
+ */
+static void LayoutTextRun(TextRun *run)
+{
+	DrawStringParams params = run->start;
+	int x = 0;
+	int y = 0;
+
+	for (const UChar *str = run->text; *str != 0; str++) {
+		UChar c = *str;
+		if (IsPrintable(c) && !IsTextDirectionChar(c)) {
+			TextRunGlyph *g = run->glyphs.Append();
+			g->x = x;
+			g->y = y;
+			g->c = c;
+			g->size = params.fontsize;
+			g->colour = params.cur_colour;
+			x += GetCharacterWidth(params.fontsize, c);
+		} else if (c == '\n') {
+			x = 0;
+			y += GetCharacterHeight(params.fontsize);
+		} else if (c >= SCC_BLUE && c <= SCC_BLACK) {
+			params.SetColour((TextColour)(c - SCC_BLUE));
+		} else if (c == SCC_PREVIOUS_COLOUR) {
+			params.SetPreviousColour();
+		} else if (c == SCC_SETX || c == SCC_SETXY) {
+			/* The characters are handled before calling this. */
+			NOT_REACHED();
+		} else if (c == SCC_TINYFONT) {
+			params.SetFontSize(FS_SMALL);
+		} else if (c == SCC_BIGFONT) {
+			params.SetFontSize(FS_LARGE);
+		} else if (!IsTextDirectionChar(c)) {
+			DEBUG(misc, 0, "[utf8] unknown string command character %d", c);
+		}
+	}
+
+	run->end = params;
+	run->end_x = x;
+	run->width = GetStringWidth(run->text, run->start.fontsize);
+}
+
+/**
+ * Get the run of a text, from the cache or by decoding it.
+ * @param text   The text, already bidi reordered.
+ * @param params The parameters the drawing starts with.
+ * @return The run; valid until the next call.
+ */
+static const TextRun *GetTextRun(const UChar *text, const DrawStringParams &params)
+{
+	uint length = 0;
+	uint32 hash = params.fontsize | params.cur_colour << 4 | params.prev_colour << 16;
+	for (const UChar *str = text; *str != 0; str++, length++) hash = hash * 31 + *str;
+
+	TextRun **bucket = &_text_run_hash[hash % TEXT_RUN_HASH_SIZE];
+	for (TextRun *run = *bucket; run != NULL; run = run->hash_next) {
+		if (run->hash != hash || run->length != length) continue;
+		if (run->start.fontsize != params.fontsize || run->start.cur_colour != params.cur_colour || run->start.prev_colour != params.prev_colour) continue;
+		if (memcmp(run->text, text, length * sizeof(UChar)) != 0) continue;
+
+		_text_run_hits++;
+		UnlinkTextRun(run);
+		LinkTextRunFirst(run);
+		return run;
+	}
+	_text_run_misses++;
+
+	if (_text_run_count == TEXT_RUN_CACHE_SIZE) {
+		/* Make room by dropping the least recently used run. */
+		TextRun *old = _text_run_lru_last;
+		UnlinkTextRun(old);
+		TextRun **prev = &_text_run_hash[old->hash % TEXT_RUN_HASH_SIZE];
+		while (*prev != old) prev = &(*prev)->hash_next;
+		*prev = old->hash_next;
+		delete old;
+		_text_run_count--;
+	}
+
+	TextRun *run = new TextRun(params);
+	run->hash = hash;
+	run->length = length;
+	run->text = MallocT<UChar>(length + 1);
+	MemCpyT(run->text, text, length + 1);
+	LayoutTextRun(run);
+
+	run->hash_next = *bucket;
+	*bucket = run;
+	LinkTextRunFirst(run);
+	_text_run_count++;
+	return run;
+}
+
+/**
+ * Draw a text run that was laid out by #LayoutTextRun.
+ * @param run    The run to draw.
+ * @param x      Offset from left side of the screen.
+ * @param y      Offset from top side of the screen.
+ * @param params Text drawing parameters; updated as if the text was parsed.
+ * @param parse_string_also_when_clipped Whether to update \a params when nothing can be drawn.
+ * @return The x-coordinate where the drawing has finished, or \a x if nothing was drawn.
+ */
+static int DrawTextRun(const TextRun *run, int x, int y, DrawStringParams &params, bool parse_string_also_when_clipped)
+{
+	DrawPixelInfo *dpi = _cur_dpi;
+
+	if (!parse_string_also_when_clipped) {
+		if (x >= dpi->left + dpi->width || y >= dpi->top + dpi->height) return x;
+	}
+
+	TextColour colour = run->start.cur_colour;
+	SetColourRemap(colour);
+
+	for (const TextRunGlyph *g = run->glyphs.Begin(); g != run->glyphs.End(); g++) {
+		int gx = x + g->x;
+		int gy = y + g->y;
+		if (gy + _max_char_height <= dpi->top || dpi->top + dpi->height <= gy) continue;
+		if (gx >= dpi->left + dpi->width || gx + _max_char_width < dpi->left) continue;
+
+		if (g->colour != colour) {
+			colour = g->colour;
+			SetColourRemap(colour);
+		}
+		GfxMainBlitter(GetGlyph(g->size, g->c), gx, gy, BM_COLOUR_REMAP);
+	}
+
+	/* Leave the colours as they are after parsing the whole string. */
+	if (colour != run->end.cur_colour) SetColourRemap(run->end.cur_colour);
+	params = run->end;
+	return x + run->end_x;
+}
+
+/**
+ * Get statistics of the cache of text runs.
+ * @param[out] entries The number of cached runs.
+ * @param[out] hits    The number of draws that used a cached run.
+ * @param[out] misses  The number of draws that had to decode the text.
+ */
+void GetTextRunCacheStats(uint *entries, uint *hits, uint *misses)
+{
+	*entries = _text_run_count;
+	*hits = _text_run_hits;
+	*misses = _text_run_misses;
+}
+
 /**
  * Draw string, possibly truncated to make it fit in its allocated space
  *
@@ -572,7 +805,8 @@ static int DrawString(int left, int right, int top, char *str, const char *last,
 		}
 
 		to_draw = HandleBiDiAndArabicShapes(to_draw);
-		int w = GetStringWidth(to_draw, params.fontsize);
+		const TextRun *run = GetTextRun(to_draw, params);
+		int w = run->width;
 
 		/* right is the right most position to draw on. In this case we want to do
 		 * calculations with the width of the string. In comparison right can be
@@ -603,7 +837,7 @@ static int DrawString(int left, int right, int top, char *str, const char *last,
 		min_left  = min(left, min_left);
 		max_right = max(right, max_right);
 
-		ReallyDoDrawString(to_draw, left, top, params, !truncate);
+		DrawTextRun(run, left, top, params, !truncate);
 		if (underline) {
 			GfxFillRect(left, top + FONT_HEIGHT_NORMAL, right, top + FONT_HEIGHT_NORMAL, _string_colourremap[1]);
 		}
@@ -1037,82 +1271,6 @@ void DrawCharCentered(WChar c, int x, int y, TextColour colour)
 	GfxMainBlitter(GetGlyph(FS_NORMAL, c), x - GetCharacterWidth(FS_NORMAL, c) / 2, y, BM_COLOUR_REMAP);
 }
 
-/**
- * Draw a string at the given coordinates with the given colour.
- *  While drawing the string, parse it in case some formatting is specified,
- *  like new colour, new size or even positionning.
- * @param string              The string to draw. This is already bidi reordered.
- * @param x                   Offset from left side of the screen
- * @param y                   Offset from top side of the screen
- * @param params              Text drawing parameters
- * @param parse_string_also_when_clipped
- *                            By default, always test the available space where to draw the string.
- *                            When in multipline drawing, it would already be done,
- *                            so no need to re-perform the same kind (more or less) of verifications.
- *                            It's not only an optimisation, it's also a way to ensures the string will be parsed
- *                            (as there are certain side effects on global variables, which are important for the next line)
- * @return                    the x-coordinates where the drawing has finished.
- *                            If nothing is drawn, the originally passed x-coordinate is returned
- */
-static int ReallyDoDrawString(const UChar *string, int x, int y, DrawStringParams &params, bool parse_string_also_when_clipped)
-{
-	DrawPixelInfo *dpi = _cur_dpi;
-	UChar c;
-	int xo = x;
-
-	if (!parse_string_also_when_clipped) {
-		/* in "mode multiline", the available space have been verified. Not in regular one.
-		 * So if the string cannot be drawn, return the original start to say so.*/
-		if (x >= dpi->left + dpi->width || y >= dpi->top + dpi->height) return x;
-	}
-
-switch_colour:;
-	SetColourRemap(params.cur_colour);
-
-check_bounds:
-	if (y + _max_char_height <= dpi->top || dpi->top + dpi->height <= y) {
-skip_char:;
-		for (;;) {
-			c = *string++;
-			if (!IsPrintable(c)) goto skip_cont;
-		}
-	}
-
-	for (;;) {
-		c = *string++;
-skip_cont:;
-		if (c == 0) {
-			return x;  // Nothing more to draw, get out. And here is the new x position
-		}
-		if (IsPrintable(c) && !IsTextDirectionChar(c)) {
-			if (x >= dpi->left + dpi->width) goto skip_char;
-			if (x + _max_char_width >= dpi->left) {
-				GfxMainBlitter(GetGlyph(params.fontsize, c), x, y, BM_COLOUR_REMAP);
-			}
-			x += GetCharacterWidth(params.fontsize, c);
-		} else if (c == '\n') { // newline = {}
-			x = xo;  // We require a new line, so the x coordinate is reset
-			y += GetCharacterHeight(params.fontsize);
-			goto check_bounds;
-		} else if (c >= SCC_BLUE && c <= SCC_BLACK) { // change colour?
-			params.SetColour((TextColour)(c - SCC_BLUE));
-			goto switch_colour;
-		} else if (c == SCC_PREVIOUS_COLOUR) { // revert to the previous colour
-			params.SetPreviousColour();
-			goto switch_colour;
-		} else if (c == SCC_SETX || c == SCC_SETXY) { // {SETX}/{SETXY}
-			/* The characters are handled before calling this. */
-			NOT_REACHED();
-		} else if (c == SCC_TINYFONT) { // {TINYFONT}
-			params.SetFontSize(FS_SMALL);
-		} else if (c == SCC_BIGFONT) { // {BIGFONT}
-			params.SetFontSize(FS_LARGE);
-		} else if (!IsTextDirectionChar(c)) {
-			DEBUG(misc, 0, "[utf8] unknown string command character %d", c);
-		}
-	}
-}
-
 /**
  * Get the size of a sprite.
  * @param sprid Sprite to examine.
@@ -1379,6 +1537,8 @@ void DoPaletteAnimations()
 /** Initialize _stringwidth_table cache */
 void LoadStringWidthTable()
 {
+	ClearTextRunCache();
+
 	_max_char_height = 0;
 	_max_char_width  = 0;
 
@@ -127,6 +127,7 @@ uint32 FormatStringLinebreaks(char *str, const char *last, int maxw, FontSize st
 int GetStringHeight(StringID str, int maxw);
 Dimension GetStringMultiLineBoundingBox(StringID str, const Dimension &suggestion);
 void LoadStringWidthTable();
+void GetTextRunCacheStats(uint *entries, uint *hits, uint *misses);
 
 void DrawDirtyBlocks();
 void SetDirtyBlocks(int left, int top, int right, int bottom);
@@ -1071,7 +1071,6 @@ class IndustryDirectoryWindow : public Window {
 protected:
 	/* Runtime saved values */
 	static Listing last_sorting;
-	static const Industry *last_industry;
 
 	/* Constants for sorting stations */
 	static const StringID sorter_names[];
@@ -1097,7 +1096,6 @@ protected:
 		}
 
 		if (!this->industries.Sort()) return;
-		IndustryDirectoryWindow::last_industry = NULL; // Reset name sorter sort cache
 		this->SetWidgetDirty(IDW_INDUSTRY_LIST); // Set the modified widget dirty
 	}
 
@@ -1136,19 +1134,10 @@ protected:
 	/** Sort industries by name */
 	static int CDECL IndustryNameSorter(const Industry * const *a, const Industry * const *b)
 	{
-		static char buf_cache[96];
-		static char buf[96];
+		/* Cached names, to spare many GetString() calls. */
+		static SortNameCache names;
 
-		SetDParam(0, (*a)->index);
-		GetString(buf, STR_INDUSTRY_NAME, lastof(buf));
-
-		if (*b != last_industry) {
-			last_industry = *b;
-			SetDParam(0, (*b)->index);
-			GetString(buf_cache, STR_INDUSTRY_NAME, lastof(buf_cache));
-		}
-
-		return strnatcmp(buf, buf_cache); // Sort by name (natural sorting).
+		return strnatcmp(names.Get((*a)->index, STR_INDUSTRY_NAME), names.Get((*b)->index, STR_INDUSTRY_NAME)); // Sort by name (natural sorting).
 	}
 
 	/** Sort industries by type and name */
@@ -1375,7 +1364,6 @@ public:
 };
 
 Listing IndustryDirectoryWindow::last_sorting = {false, 0};
-const Industry *IndustryDirectoryWindow::last_industry = NULL;
 
 /* Available station sorting functions. */
 GUIIndustryList::SortFunction * const IndustryDirectoryWindow::sorter_funcs[] = {
@@ -32,6 +32,7 @@
 #include "water_map.h"
 #include "economy_func.h"
 #include "company_func.h"
+#include "debug.h"
 
 #include "table/strings.h"
 #include "table/sprites.h"
@@ -711,6 +712,8 @@ CommandCost CmdClearArea(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 
 
 TileIndex _cur_tileloop_tile;
+bool _tile_loop_profiling = false;                                  ///< Whether to measure the time spent in the tile loop of each tile type.
+static TileLoopStats _tile_loop_stats[lengthof(_tile_type_procs)]; ///< Statistics of the tile loop per tile type.
 #define TILELOOP_BITS 4
 #define TILELOOP_SIZE (1 << TILELOOP_BITS)
 #define TILELOOP_ASSERTMASK ((TILELOOP_SIZE - 1) + ((TILELOOP_SIZE - 1) << MapLogX()))
@@ -723,7 +726,19 @@ void RunTileLoop()
 	assert((tile & ~TILELOOP_ASSERTMASK) == 0);
 	uint count = (MapSizeX() / TILELOOP_SIZE) * (MapSizeY() / TILELOOP_SIZE);
 	do {
-		_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
+		TileType type = GetTileType(tile);
+		TileLoopProc *proc = _tile_type_procs[type]->tile_loop_proc;
+		_tile_loop_stats[type].tiles++;
+
+		if (proc != NULL) {
+			if (_tile_loop_profiling) {
+				uint64 start = ottd_rdtsc();
+				proc(tile);
+				_tile_loop_stats[type].cycles += ottd_rdtsc() - start;
+			} else {
+				proc(tile);
+			}
+		}
 
 		if (TileX(tile) < MapSizeX() - TILELOOP_SIZE) {
 			tile += TILELOOP_SIZE; // no overflow
@@ -740,6 +755,22 @@ void RunTileLoop()
 	_cur_tileloop_tile = tile;
 }
 
+/**
+ * Get the statistics of the tile loop of a tile type.
+ * @param type The tile type.
+ * @return The statistics.
+ */
+const TileLoopStats *GetTileLoopStats(TileType type)
+{
+	return &_tile_loop_stats[type];
+}
+
+/** Start counting the statistics of the tile loop anew. */
+void ResetTileLoopStats()
+{
+	MemSetT(_tile_loop_stats, 0, lengthof(_tile_loop_stats));
+}
+
 void InitializeLandscape()
 {
 	uint maxx = MapMaxX();
@@ -92,6 +92,16 @@ bool HasFoundationNE(TileIndex tile, Slope slope_here, uint z_here);
 void DoClearSquare(TileIndex tile);
 void RunTileLoop();
 
+/** Statistics of running the tile loop for one tile type. */
+struct TileLoopStats {
+	uint64 tiles;  ///< Number of tiles of the type the tile loop visited.
+	uint64 cycles; ///< CPU ticks spent in the tile loop of the type, while profiling.
+};
+
+extern bool _tile_loop_profiling;
+const TileLoopStats *GetTileLoopStats(TileType type);
+void ResetTileLoopStats();
+
 void InitializeLandscape();
 void GenerateLandscape(byte mode);
 
@@ -14,6 +14,7 @@
 #include "core/alloc_func.hpp"
 #include "tile_map.h"
 #include "water_map.h"
+#include "station_func.h"
 
 #if defined(_MSC_VER)
 /* Why the hell is that not in all MSVC headers?? */
@@ -61,6 +62,10 @@ void AllocateMap(uint size_x, uint size_y)
 
 	_m = CallocT<Tile>(_map_size);
 	_me = CallocT<TileExtended>(_map_size);
+
+	InitializeFloodFrontier();
+	InitializeStationAcceptanceCaches();
+	InvalidateSignalSegments();
 }
 
 
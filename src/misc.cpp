@@ -46,6 +46,7 @@ void InitializeTrees();
 void InitializeCompanies();
 void InitializeCheats();
 void InitializeNPF();
+void InitializeWaterRegions();
 void InitializeOldNames();
 
 void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settings)
@@ -90,6 +91,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	InitializeBuildingCounts();
 
 	InitializeNPF();
+	InitializeWaterRegions();
 
 	InitializeCompanies();
 	AI::Initialize();
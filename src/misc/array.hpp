@@ -45,6 +45,15 @@ public:
 	FORCEINLINE SmallArray() { }
 	/** Clear (destroy) all items */
 	FORCEINLINE void Clear() {data.Clear();}
+	/** Destroy all items, but keep the memory of the first sub-array for reuse */
+	FORCEINLINE void Reset()
+	{
+		if (data.Length() > 1) {
+			data.Clear();
+		} else if (data.Length() == 1) {
+			data[0].Clear();
+		}
+	}
 	/** Return actual number of items */
 	FORCEINLINE uint Length() const
 	{
@@ -54,7 +63,7 @@ public:
 		return (super_size - 1) * B + sub_size;
 	}
 	/** return true if array is empty */
-	FORCEINLINE bool IsEmpty() { return data.IsEmpty(); }
+	FORCEINLINE bool IsEmpty() { return Length() == 0; }
 	/** return true if array is full */
 	FORCEINLINE bool IsFull() { return data.IsFull() && data[N - 1].IsFull(); }
 	/** allocate but not construct new item */
@@ -177,6 +177,20 @@ public:
 	/** simple clear - forget all items - used by CSegmentCostCacheT.Flush() */
 	FORCEINLINE void Clear() {for (int i = 0; i < Tcapacity; i++) m_slots[i].Clear();}
 
+	/**
+	 * forget all items, given all items that could have been stored in the table;
+	 *  clears only their slots when that is cheaper than clearing all slots
+	 */
+	template <class Tarray> FORCEINLINE void ClearItems(const Tarray& items)
+	{
+		if (items.Length() >= (uint)Tcapacity) {
+			Clear();
+		} else {
+			for (uint i = 0; i < items.Length(); i++) m_slots[CalcHash(items[i])].Clear();
+		}
+		m_num_items = 0;
+	}
+
 	/** const item search */
 	const Titem_ *Find(const Tkey& key) const
 	{
@@ -12,6 +12,17 @@
 #include "stdafx.h"
 #include <math.h>
 #include "core/math_func.hpp"
+#include "core/alloc_func.hpp"
+#include "core/mem_func.hpp"
+#include "debug.h"
+#include "thread/thread.h"
+#include "mixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	/** The compiler targets CPUs with SSE2, so we can mix eight samples at once. */
+#	define WITH_MIXER_SSE2
+#	include <emmintrin.h>
+#endif
 
 struct MixerChannel {
 	bool active;
@@ -25,20 +36,28 @@ struct MixerChannel {
 	uint32 frac_speed;
 	uint32 samples_left;
 
-	/* Mixing volume */
+	/* Mixing volume, range is 0..32767 */
 	int volume_left;
 	int volume_right;
 
+	uint priority; ///< Priority of the sound; the channel with the lowest priority is taken over first.
+
 	bool is16bit;
 };
 
-static MixerChannel _channels[8];
+/** Number of sounds that can be played at the same time. */
+static const uint MIXER_CHANNELS = 32;
+/** Number of samples that are mixed in one go. */
+static const uint MIXER_BLOCK_SIZE = 256;
+
+static MixerChannel _channels[MIXER_CHANNELS];
 #if defined(__PLAYBOOK__)
 static MixerChannel _musicChannel;
 void (*musicCallback)(int16*,uint);
 #endif
-static uint32 _play_rate = 11025;
+static uint32 _play_rate = 44100;
 static uint32 _max_size = UINT_MAX;
+static ThreadMutex *_mixer_mutex = NULL; ///< Guards the channels against the thread of the sound driver.
 
 /**
  * The theoretical maximum volume for a single sound sample. Multiple sound
@@ -61,101 +80,155 @@ static int RateConversion(T *b, int frac_pos)
 	return ((b[0] * ((1 << 16) - frac_pos)) + (b[1] * frac_pos)) >> 16;
 }
 
-static void mix_int16(MixerChannel *sc, int16 *buffer, uint samples)
+/**
+ * Get the next samples of a channel as 16 bits samples at the output rate.
+ * 8 bits samples are scaled up, so they can be mixed the same way.
+ * @param sc      The channel to get the samples of.
+ * @param buf     Buffer for the samples when they need converting.
+ * @param samples Number of samples to get.
+ * @return The samples; either the memory of the channel itself or \a buf.
+ */
+static const int16 *FetchSamples(MixerChannel *sc, int16 *buf, uint samples)
 {
-	if (samples > sc->samples_left) samples = sc->samples_left;
-	sc->samples_left -= samples;
-	assert(samples > 0);
-
-	const int16 *b = (const int16 *)sc->memory + sc->pos;
+	const int16 *result = buf;
 	uint32 frac_pos = sc->frac_pos;
 	uint32 frac_speed = sc->frac_speed;
-	int volume_left = sc->volume_left;
-	int volume_right = sc->volume_right;
-
-	if (frac_speed == 0x10000) {
-		/* Special case when frac_speed is 0x10000 */
-		do {
-			buffer[0] = Clamp(buffer[0] + (*b * volume_left  >> 16), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (*b * volume_right >> 16), -MAX_VOLUME, MAX_VOLUME);
-			b++;
-			buffer += 2;
-		} while (--samples > 0);
+
+	if (sc->is16bit) {
+		const int16 *b = (const int16 *)sc->memory + sc->pos;
+		if (frac_speed == 0x10000) {
+			/* Special case when frac_speed is 0x10000; nothing to convert */
+			result = b;
+			b += samples;
+		} else {
+			for (uint i = 0; i < samples; i++) {
+				buf[i] = RateConversion(b, frac_pos);
+				frac_pos += frac_speed;
+				b += frac_pos >> 16;
+				frac_pos &= 0xffff;
+			}
+		}
+		sc->pos = b - (const int16 *)sc->memory;
 	} else {
-		do {
-			int data = RateConversion(b, frac_pos);
-			buffer[0] = Clamp(buffer[0] + (data * volume_left  >> 16), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (data * volume_right >> 16), -MAX_VOLUME, MAX_VOLUME);
-			buffer += 2;
-			frac_pos += frac_speed;
-			b += frac_pos >> 16;
-			frac_pos &= 0xffff;
-		} while (--samples > 0);
+		const int8 *b = sc->memory + sc->pos;
+		if (frac_speed == 0x10000) {
+			/* Special case when frac_speed is 0x10000 */
+			for (uint i = 0; i < samples; i++) buf[i] = b[i] * 256;
+			b += samples;
+		} else {
+			for (uint i = 0; i < samples; i++) {
+				buf[i] = RateConversion(b, frac_pos) * 256;
+				frac_pos += frac_speed;
+				b += frac_pos >> 16;
+				frac_pos &= 0xffff;
+			}
+		}
+		sc->pos = b - sc->memory;
 	}
 
 	sc->frac_pos = frac_pos;
-	sc->pos = b - (const int16 *)sc->memory;
+	return result;
 }
 
-static void mix_int8_to_int16(MixerChannel *sc, int16 *buffer, uint samples)
+/**
+ * Add mono samples to the left and right channels of the mixing buffer.
+ * @param acc          The mixing buffer, with interleaved left and right samples.
+ * @param src          The samples to add.
+ * @param samples      Number of samples to add.
+ * @param volume_left  Volume of the left channel, range is 0..32767.
+ * @param volume_right Volume of the right channel, range is 0..32767.
+ */
+static void MixSamples(int32 *acc, const int16 *src, uint samples, int volume_left, int volume_right)
 {
-	if (samples > sc->samples_left) samples = sc->samples_left;
-	sc->samples_left -= samples;
-	assert(samples > 0);
-
-	const int8 *b = sc->memory + sc->pos;
-	uint32 frac_pos = sc->frac_pos;
-	uint32 frac_speed = sc->frac_speed;
-	int volume_left = sc->volume_left;
-	int volume_right = sc->volume_right;
-
-	if (frac_speed == 0x10000) {
-		/* Special case when frac_speed is 0x10000 */
-		do {
-			buffer[0] = Clamp(buffer[0] + (*b * volume_left  >> 8), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (*b * volume_right >> 8), -MAX_VOLUME, MAX_VOLUME);
-			b++;
-			buffer += 2;
-		} while (--samples > 0);
-	} else {
-		do {
-			int data = RateConversion(b, frac_pos);
-			buffer[0] = Clamp(buffer[0] + (data * volume_left  >> 8), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (data * volume_right >> 8), -MAX_VOLUME, MAX_VOLUME);
-			buffer += 2;
-			frac_pos += frac_speed;
-			b += frac_pos >> 16;
-			frac_pos &= 0xffff;
-		} while (--samples > 0);
+	uint i = 0;
+
+#ifdef WITH_MIXER_SSE2
+	const __m128i volume = _mm_set_epi16(volume_right, volume_left, volume_right, volume_left, volume_right, volume_left, volume_right, volume_left);
+	for (; i + 8 <= samples; i += 8) {
+		__m128i data = _mm_loadu_si128((const __m128i *)(src + i));
+		/* Duplicate each sample for both channels and keep the upper half of the product, i.e. '* volume >> 16'. */
+		__m128i lo = _mm_mulhi_epi16(_mm_unpacklo_epi16(data, data), volume);
+		__m128i hi = _mm_mulhi_epi16(_mm_unpackhi_epi16(data, data), volume);
+
+		/* Sign extend to 32 bits and add to what is there. */
+		__m128i *a = (__m128i *)(acc + 2 * i);
+		_mm_storeu_si128(a + 0, _mm_add_epi32(_mm_loadu_si128(a + 0), _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)));
+		_mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)));
+		_mm_storeu_si128(a + 2, _mm_add_epi32(_mm_loadu_si128(a + 2), _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)));
+		_mm_storeu_si128(a + 3, _mm_add_epi32(_mm_loadu_si128(a + 3), _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)));
 	}
+#endif /* WITH_MIXER_SSE2 */
 
-	sc->frac_pos = frac_pos;
-	sc->pos = b - sc->memory;
+	for (; i < samples; i++) {
+		acc[2 * i]     += src[i] * volume_left  >> 16;
+		acc[2 * i + 1] += src[i] * volume_right >> 16;
+	}
 }
 
-static void MxCloseChannel(MixerChannel *mc)
+/**
+ * Write the mixed samples to the output, limited to the maximum volume.
+ * @param buffer The output buffer.
+ * @param acc    The mixing buffer.
+ * @param count  Number of values, i.e. twice the number of samples.
+ */
+static void ClampSamples(int16 *buffer, const int32 *acc, uint count)
 {
-	mc->active = false;
+	uint i = 0;
+
+#ifdef WITH_MIXER_SSE2
+	const __m128i max = _mm_set1_epi16(MAX_VOLUME);
+	const __m128i min = _mm_set1_epi16(-MAX_VOLUME);
+	for (; i + 8 <= count; i += 8) {
+		__m128i data = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)(acc + i)), _mm_loadu_si128((const __m128i *)(acc + i + 4)));
+		_mm_storeu_si128((__m128i *)(buffer + i), _mm_min_epi16(_mm_max_epi16(data, min), max));
+	}
+#endif /* WITH_MIXER_SSE2 */
+
+	for (; i < count; i++) {
+		buffer[i] = Clamp(acc[i], -MAX_VOLUME, MAX_VOLUME);
+	}
 }
 
-void MxMixSamples(void *buffer, uint samples)
+/**
+ * Mix a number of channels.
+ * @param channels The channels to mix.
+ * @param count    Number of channels.
+ * @param buffer   The output buffer.
+ * @param samples  Number of samples to mix.
+ */
+static void MixChannels(MixerChannel *channels, uint count, int16 *buffer, uint samples)
 {
-	MixerChannel *mc;
-
-	/* Clear the buffer */
-	memset(buffer, 0, sizeof(int16) * 2 * samples);
-
-	/* Mix each channel */
-	for (mc = _channels; mc != endof(_channels); mc++) {
-		if (mc->active) {
-			if (mc->is16bit) {
-				mix_int16(mc, (int16*)buffer, samples);
-			} else {
-				mix_int8_to_int16(mc, (int16*)buffer, samples);
-			}
-			if (mc->samples_left == 0) MxCloseChannel(mc);
+	int32 acc[2 * MIXER_BLOCK_SIZE];
+	int16 buf[MIXER_BLOCK_SIZE];
+
+	while (samples > 0) {
+		uint n = min(samples, MIXER_BLOCK_SIZE);
+		MemSetT(acc, 0, 2 * n);
+
+		for (MixerChannel *mc = channels; mc != channels + count; mc++) {
+			if (!mc->active) continue;
+
+			uint m = min(n, mc->samples_left);
+			MixSamples(acc, FetchSamples(mc, buf, m), m, mc->volume_left, mc->volume_right);
+			mc->samples_left -= m;
+			if (mc->samples_left == 0) mc->active = false;
 		}
+
+		ClampSamples(buffer, acc, 2 * n);
+		buffer += 2 * n;
+		samples -= n;
 	}
+}
+
+void MxMixSamples(void *buffer, uint samples)
+{
+	ThreadMutex *mutex = _mixer_mutex;
+	if (mutex != NULL) mutex->BeginCritical();
+
+	MixChannels(_channels, lengthof(_channels), (int16 *)buffer, samples);
+
+	if (mutex != NULL) mutex->EndCritical();
+
 #if defined(__PLAYBOOK__)
 	if (_musicChannel.active) {
 		(*musicCallback)((int16*)buffer, samples);
@@ -163,17 +236,38 @@ void MxMixSamples(void *buffer, uint samples)
 #endif
 }
 
-MixerChannel *MxAllocateChannel()
+/**
+ * Get a channel to play a sound on. When all channels are in use, the one
+ * playing the sound with the lowest priority is taken over, provided that
+ * priority is lower than the priority of the new sound.
+ * @param priority Priority of the new sound.
+ * @return The channel, or NULL when the sound should not be played.
+ */
+MixerChannel *MxAllocateChannel(uint priority)
 {
-	MixerChannel *mc;
-	for (mc = _channels; mc != endof(_channels); mc++) {
+	MixerChannel *best = NULL;
+
+	if (_mixer_mutex != NULL) _mixer_mutex->BeginCritical();
+	for (MixerChannel *mc = _channels; mc != endof(_channels); mc++) {
 		if (!mc->active) {
-			free(mc->memory);
-			mc->memory = NULL;
-			return mc;
+			best = mc;
+			break;
+		}
+		/* Of equally important sounds, take over the one that is nearly done. */
+		if (mc->priority < priority && (best == NULL || mc->priority < best->priority ||
+				(mc->priority == best->priority && mc->samples_left < best->samples_left))) {
+			best = mc;
 		}
 	}
-	return NULL;
+	if (best != NULL) best->active = false;
+	if (_mixer_mutex != NULL) _mixer_mutex->EndCritical();
+
+	if (best == NULL) return NULL;
+
+	free(best->memory);
+	best->memory = NULL;
+	best->priority = priority;
+	return best;
 }
 
 #if defined(__PLAYBOOK__)
@@ -242,13 +336,52 @@ void MxSetChannelVolume(MixerChannel *mc, uint volume, float pan)
 
 void MxActivateChannel(MixerChannel *mc)
 {
+	/* The lock makes sure the mixer sees the channel completely set up. */
+	if (_mixer_mutex != NULL) _mixer_mutex->BeginCritical();
 	mc->active = true;
+	if (_mixer_mutex != NULL) _mixer_mutex->EndCritical();
 }
 
 
 bool MxInitialize(uint rate)
 {
+	if (_mixer_mutex == NULL) _mixer_mutex = ThreadMutex::New();
 	_play_rate = rate;
 	_max_size  = UINT_MAX / _play_rate;
 	return true;
 }
+
+/**
+ * Measure how long it takes to mix one second of sound at the output rate.
+ * Half of the sounds are 8 bits and half are 16 bits, all at the rate of
+ * the original sounds, so they all need rate conversion.
+ * @param channels Number of sounds to mix; at most the number of channels of the mixer.
+ * @return Number of CPU ticks mixing took.
+ */
+uint64 MxBenchmark(uint channels)
+{
+	static const uint BENCHMARK_RATE = 11025;
+
+	/* Room for a second of 16 bits samples, and the sample after it for the rate conversion. */
+	int8 *mem = MallocT<int8>(BENCHMARK_RATE * 2 + 4);
+	for (uint i = 0; i < BENCHMARK_RATE * 2 + 4; i++) mem[i] = (int8)(i * 37);
+
+	channels = min(channels, MIXER_CHANNELS);
+	MixerChannel bench[MIXER_CHANNELS];
+	MemSetT(bench, 0, lengthof(bench));
+	for (uint i = 0; i < channels; i++) {
+		bool is16bit = (i % 2) != 0;
+		MxSetChannelRawSrc(&bench[i], mem, is16bit ? BENCHMARK_RATE * 2 : BENCHMARK_RATE, BENCHMARK_RATE, is16bit);
+		MxSetChannelVolume(&bench[i], 8192, (float)i / channels);
+		bench[i].active = true;
+	}
+
+	int16 *buffer = MallocT<int16>(2 * _play_rate);
+	uint64 start = ottd_rdtsc();
+	MixChannels(bench, channels, buffer, _play_rate);
+	uint64 ticks = ottd_rdtsc() - start;
+
+	free(buffer);
+	free(mem);
+	return ticks;
+}
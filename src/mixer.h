@@ -17,11 +17,13 @@ struct MixerChannel;
 bool MxInitialize(uint rate);
 void MxMixSamples(void *buffer, uint samples);
 
-MixerChannel *MxAllocateChannel();
+MixerChannel *MxAllocateChannel(uint priority);
 void MxSetChannelRawSrc(MixerChannel *mc, int8 *mem, size_t size, uint rate, bool is16bit);
 void MxSetChannelVolume(MixerChannel *mc, uint volume, float pan);
 void MxActivateChannel(MixerChannel*);
 
+uint64 MxBenchmark(uint channels);
+
 #if defined(__PLAYBOOK__)
 MixerChannel *MxAllocateMusicChannel(void (*callback)(int16*,uint));
 void MxMixMusic(int16* buffer, uint samples, const int16 *music);
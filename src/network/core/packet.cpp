@@ -15,9 +15,49 @@
 
 #include "../../stdafx.h"
 #include "../../string_func.h"
+#include "../../core/smallvec_type.hpp"
+#include "../../thread/thread.h"
 
 #include "packet.h"
 
+/** Maximum number of unused packet buffers that are kept for reuse. */
+static const uint PACKET_BUFFER_POOL_SIZE = 256;
+/** Buffers of packets that are gone, kept so new packets do not need to allocate. */
+static SmallVector<byte *, 64> _packet_buffer_pool;
+/** Packets are also made by the threads that save the game for joining clients and query servers. */
+static ThreadMutex *_packet_buffer_pool_mutex = ThreadMutex::New();
+
+/**
+ * Get a buffer of SEND_MTU bytes for a packet.
+ * @return The buffer.
+ */
+static byte *AllocatePacketBuffer()
+{
+	byte *buffer = NULL;
+	_packet_buffer_pool_mutex->BeginCritical();
+	if (_packet_buffer_pool.Length() > 0) {
+		buffer = *(_packet_buffer_pool.End() - 1);
+		_packet_buffer_pool.Erase(_packet_buffer_pool.End() - 1);
+	}
+	_packet_buffer_pool_mutex->EndCritical();
+	return buffer != NULL ? buffer : MallocT<byte>(SEND_MTU);
+}
+
+/**
+ * Give a buffer of SEND_MTU bytes back to the pool.
+ * @param buffer The buffer that is no longer used.
+ */
+static void FreePacketBuffer(byte *buffer)
+{
+	_packet_buffer_pool_mutex->BeginCritical();
+	if (_packet_buffer_pool.Length() < PACKET_BUFFER_POOL_SIZE) {
+		*_packet_buffer_pool.Append() = buffer;
+		buffer = NULL;
+	}
+	_packet_buffer_pool_mutex->EndCritical();
+	free(buffer);
+}
+
 /**
  * Create a packet that is used to read from a network socket
  * @param cs the socket handler associated with the socket we are reading from
@@ -30,7 +70,8 @@ Packet::Packet(NetworkSocketHandler *cs)
 	this->next   = NULL;
 	this->pos    = 0; // We start reading from here
 	this->size   = 0;
-	this->buffer = MallocT<byte>(SEND_MTU);
+	this->buffer = AllocatePacketBuffer();
+	this->shrunk = false;
 }
 
 /**
@@ -45,7 +86,8 @@ Packet::Packet(PacketType type)
 	/* Skip the size so we can write that in before sending the packet */
 	this->pos                  = 0;
 	this->size                 = sizeof(PacketSize);
-	this->buffer               = MallocT<byte>(SEND_MTU);
+	this->buffer               = AllocatePacketBuffer();
+	this->shrunk               = false;
 	this->buffer[this->size++] = type;
 }
 
@@ -54,7 +96,11 @@ Packet::Packet(PacketType type)
  */
 Packet::~Packet()
 {
-	free(this->buffer);
+	if (this->shrunk) {
+		free(this->buffer);
+	} else {
+		FreePacketBuffer(this->buffer);
+	}
 }
 
 /**
@@ -70,6 +116,22 @@ void Packet::PrepareToSend()
 	this->pos  = 0; // We start reading from here
 }
 
+/**
+ * Reallocate the buffer to the size of the packet. Packets that have to wait
+ * in a queue for a long time should not keep the full SEND_MTU bytes, as that
+ * wastes memory, especially when someone tries to do a denial of service attack!
+ */
+void Packet::Shrink()
+{
+	if (this->shrunk) return;
+
+	byte *buffer = MallocT<byte>(this->size);
+	memcpy(buffer, this->buffer, this->size);
+	FreePacketBuffer(this->buffer);
+	this->buffer = buffer;
+	this->shrunk = true;
+}
+
 /*
  * The next couple of functions make sure we can send
  *  uint8, uint16, uint32 and uint64 endian-safe
@@ -53,11 +53,16 @@ struct Packet {
 	PacketSize pos;
 	/** The buffer of this packet, of basically variable length up to SEND_MTU. */
 	byte *buffer;
+	/** Whether the buffer was shrunk to the size of the packet, so it cannot be reused by other packets. */
+	bool shrunk;
 
 private:
 	/** Socket we're associated with. */
 	NetworkSocketHandler *cs;
 
+	/* Packets received by the network I/O thread change hands. */
+	friend class NetworkTCPSocketHandler;
+
 public:
 	Packet(NetworkSocketHandler *cs);
 	Packet(PacketType type);
@@ -65,6 +70,7 @@ public:
 
 	/* Sending/writing of packets */
 	void PrepareToSend();
+	void Shrink();
 
 	void Send_bool  (bool   data);
 	void Send_uint8 (uint8  data);
@@ -0,0 +1,266 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file poller.cpp Backends for waiting for many sockets at once.
+ */
+
+#ifdef ENABLE_NETWORK
+
+#include "../../stdafx.h"
+#include "../../debug.h"
+#include "../../core/smallvec_type.hpp"
+#include "poller.h"
+
+#ifdef WITH_EPOLL
+#	include <sys/epoll.h>
+#	include <poll.h>
+#endif
+
+/** Poller on top of select; works everywhere, but has to walk all sockets on every poll. */
+class SelectSocketPoller : public SocketPoller {
+	/** A watched socket. */
+	struct Entry {
+		SOCKET sock;             ///< The socket.
+		size_t id;               ///< Identifier of the socket.
+		SocketPollEvents events; ///< What to watch for.
+	};
+
+	SmallVector<Entry, 16> entries; ///< All watched sockets.
+
+	/**
+	 * Find the entry of a socket.
+	 * @param s The socket to look for.
+	 * @return The entry, or NULL when the socket is not watched.
+	 */
+	Entry *Find(SOCKET s)
+	{
+		for (Entry *e = this->entries.Begin(); e != this->entries.End(); e++) {
+			if (e->sock == s) return e;
+		}
+		return NULL;
+	}
+
+public:
+	/* virtual */ bool Add(SOCKET s, SocketPollEvents events, size_t id)
+	{
+#if !defined(WIN32) && !defined(WIN64)
+		/* Outside of Windows an fd_set is a bitmap indexed by the socket. */
+		if (s >= FD_SETSIZE) return false;
+#endif
+		Entry *e = this->entries.Append();
+		e->sock = s;
+		e->id = id;
+		e->events = events;
+		return true;
+	}
+
+	/* virtual */ void Modify(SOCKET s, SocketPollEvents events, size_t id)
+	{
+		Entry *e = this->Find(s);
+		if (e == NULL) return;
+		e->id = id;
+		e->events = events;
+	}
+
+	/* virtual */ void Remove(SOCKET s)
+	{
+		Entry *e = this->Find(s);
+		if (e != NULL) this->entries.Erase(e);
+	}
+
+	/* virtual */ uint Poll(SocketPollResult *results, uint max_results)
+	{
+		uint found = 0;
+
+		/* Windows limits the number of sockets in an fd_set, so ask in chunks. */
+		for (uint first = 0; first < this->entries.Length() && found < max_results; first += FD_SETSIZE) {
+			uint last = min(first + FD_SETSIZE, this->entries.Length());
+
+			fd_set read_fd, write_fd;
+			struct timeval tv;
+
+			FD_ZERO(&read_fd);
+			FD_ZERO(&write_fd);
+
+			for (uint i = first; i < last; i++) {
+				const Entry &e = this->entries[i];
+				if (e.events & SPE_READ) FD_SET(e.sock, &read_fd);
+				if (e.events & SPE_WRITE) FD_SET(e.sock, &write_fd);
+			}
+
+			tv.tv_sec = tv.tv_usec = 0; // don't block at all.
+#if !defined(__MORPHOS__) && !defined(__AMIGA__)
+			int n = select(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv);
+#else
+			int n = WaitSelect(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv, NULL);
+#endif
+			if (n <= 0) continue;
+
+			for (uint i = first; i < last && found < max_results; i++) {
+				const Entry &e = this->entries[i];
+				SocketPollEvents events = SPE_NONE;
+				if (FD_ISSET(e.sock, &read_fd)) events |= SPE_READ;
+				if (FD_ISSET(e.sock, &write_fd)) events |= SPE_WRITE;
+				if (events == SPE_NONE) continue;
+
+				results[found].sock = e.sock;
+				results[found].id = e.id;
+				results[found].events = events;
+				found++;
+			}
+		}
+
+		return found;
+	}
+
+	/* virtual */ uint GetCount() const { return this->entries.Length(); }
+
+	/* virtual */ const char *GetName() const { return "select"; }
+};
+
+#ifdef WITH_EPOLL
+/** Poller on top of Linux' epoll; the kernel keeps the list of ready sockets for us. */
+class EpollSocketPoller : public SocketPoller {
+	int epoll_fd; ///< The epoll instance.
+	uint count;   ///< Number of watched sockets.
+
+	/**
+	 * Convert our events to epoll's.
+	 * @param events The events to convert.
+	 * @return The epoll events.
+	 */
+	static uint32 ToEpoll(SocketPollEvents events)
+	{
+		return ((events & SPE_READ) != 0 ? (uint32)EPOLLIN : 0) | ((events & SPE_WRITE) != 0 ? (uint32)EPOLLOUT : 0);
+	}
+
+public:
+	/**
+	 * Create the epoll instance.
+	 * @param epoll_fd The file descriptor of the epoll instance.
+	 */
+	EpollSocketPoller(int epoll_fd) : epoll_fd(epoll_fd), count(0) {}
+
+	/** Close the epoll instance. */
+	~EpollSocketPoller()
+	{
+		close(this->epoll_fd);
+	}
+
+	/* virtual */ bool Add(SOCKET s, SocketPollEvents events, size_t id)
+	{
+		struct epoll_event ev;
+		ev.events = ToEpoll(events);
+		ev.data.u64 = ((uint64)id << 32) | (uint32)s;
+		if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, s, &ev) != 0) return false;
+
+		this->count++;
+		return true;
+	}
+
+	/* virtual */ void Modify(SOCKET s, SocketPollEvents events, size_t id)
+	{
+		struct epoll_event ev;
+		ev.events = ToEpoll(events);
+		ev.data.u64 = ((uint64)id << 32) | (uint32)s;
+		epoll_ctl(this->epoll_fd, EPOLL_CTL_MOD, s, &ev);
+	}
+
+	/* virtual */ void Remove(SOCKET s)
+	{
+		/* Kernels before 2.6.9 want a non-NULL event, even though it is ignored. */
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		if (epoll_ctl(this->epoll_fd, EPOLL_CTL_DEL, s, &ev) == 0) this->count--;
+	}
+
+	/* virtual */ uint Poll(SocketPollResult *results, uint max_results)
+	{
+		if (max_results == 0) return 0;
+
+		struct epoll_event *events = AllocaM(struct epoll_event, max_results);
+		int n = epoll_wait(this->epoll_fd, events, max_results, 0);
+		if (n <= 0) return 0;
+
+		for (int i = 0; i < n; i++) {
+			results[i].sock = (SOCKET)(uint32)events[i].data.u64;
+			results[i].id = (size_t)(events[i].data.u64 >> 32);
+			results[i].events = SPE_NONE;
+			/* Errors and hang-ups are found out by reading. */
+			if ((events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) results[i].events |= SPE_READ;
+			if ((events[i].events & EPOLLOUT) != 0) results[i].events |= SPE_WRITE;
+		}
+		return n;
+	}
+
+	/* virtual */ uint GetCount() const { return this->count; }
+
+	/* virtual */ const char *GetName() const { return "epoll"; }
+};
+#endif /* WITH_EPOLL */
+
+/**
+ * Create the best poller available on this system.
+ * @return The poller; never NULL.
+ */
+/* static */ SocketPoller *SocketPoller::Create()
+{
+#ifdef WITH_EPOLL
+	int fd = epoll_create(64);
+	if (fd != -1) return new EpollSocketPoller(fd);
+#endif
+	return new SelectSocketPoller();
+}
+
+/**
+ * Check a single socket for readiness, without blocking.
+ * @param s      The socket to check.
+ * @param events What to check the socket for.
+ * @return What the socket is ready for.
+ */
+SocketPollEvents PollSocket(SOCKET s, SocketPollEvents events)
+{
+	SocketPollEvents ready = SPE_NONE;
+
+#ifdef WITH_EPOLL
+	/* poll has no limit on the value of the socket, unlike select. */
+	struct pollfd pfd;
+	pfd.fd = s;
+	pfd.events = ((events & SPE_READ) != 0 ? POLLIN : 0) | ((events & SPE_WRITE) != 0 ? POLLOUT : 0);
+	pfd.revents = 0;
+	if (poll(&pfd, 1, 0) <= 0) return SPE_NONE;
+
+	if ((pfd.revents & (POLLIN | POLLERR | POLLHUP)) != 0) ready |= SPE_READ;
+	if ((pfd.revents & POLLOUT) != 0) ready |= SPE_WRITE;
+#else
+	fd_set read_fd, write_fd;
+	struct timeval tv;
+
+	FD_ZERO(&read_fd);
+	FD_ZERO(&write_fd);
+
+	if (events & SPE_READ) FD_SET(s, &read_fd);
+	if (events & SPE_WRITE) FD_SET(s, &write_fd);
+
+	tv.tv_sec = tv.tv_usec = 0; // don't block at all.
+#if !defined(__MORPHOS__) && !defined(__AMIGA__)
+	select(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv);
+#else
+	WaitSelect(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv, NULL);
+#endif
+
+	if (FD_ISSET(s, &read_fd)) ready |= SPE_READ;
+	if (FD_ISSET(s, &write_fd)) ready |= SPE_WRITE;
+#endif /* WITH_EPOLL */
+
+	return ready;
+}
+
+#endif /* ENABLE_NETWORK */
@@ -0,0 +1,103 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file poller.h Waiting for many sockets at once without walking all of them.
+ */
+
+#ifndef NETWORK_CORE_POLLER_H
+#define NETWORK_CORE_POLLER_H
+
+#include "os_abstraction.h"
+#include "../../core/enum_type.hpp"
+
+#ifdef ENABLE_NETWORK
+
+#if defined(__linux__)
+#	define WITH_EPOLL
+#endif
+
+/** The things a socket can become ready for. */
+enum SocketPollEvents {
+	SPE_NONE  = 0,      ///< Nothing.
+	SPE_READ  = 1 << 0, ///< There is data to read, a connection to accept or the connection was closed.
+	SPE_WRITE = 1 << 1, ///< More data can be sent.
+};
+DECLARE_ENUM_AS_BIT_SET(SocketPollEvents)
+
+/** A socket that became ready, as returned by SocketPoller::Poll. */
+struct SocketPollResult {
+	SOCKET sock;             ///< The socket that became ready.
+	size_t id;               ///< The identifier given when adding the socket.
+	SocketPollEvents events; ///< What the socket is ready for.
+};
+
+/**
+ * A set of sockets that can be checked for readiness in one go.
+ * Sockets stay in the set until they are removed, so the backends do not
+ * need to be told about every socket each time they are polled.
+ */
+class SocketPoller {
+public:
+	/** Make sure the backend gets cleaned up. */
+	virtual ~SocketPoller() {}
+
+	/**
+	 * Start watching a socket.
+	 * @param s      The socket to watch.
+	 * @param events What to watch the socket for.
+	 * @param id     Identifier returned with the socket when it becomes ready.
+	 * @return True when the socket is being watched.
+	 * @note Failures are not logged, as pollers are also used on the network
+	 *       I/O thread; the caller has to report them from the game thread.
+	 */
+	virtual bool Add(SOCKET s, SocketPollEvents events, size_t id) = 0;
+
+	/**
+	 * Change what a socket is watched for.
+	 * @param s      The socket that is already being watched.
+	 * @param events What to watch the socket for from now on.
+	 * @param id     Identifier returned with the socket when it becomes ready.
+	 */
+	virtual void Modify(SOCKET s, SocketPollEvents events, size_t id) = 0;
+
+	/**
+	 * Stop watching a socket; must be done before closing it.
+	 * @param s The socket to stop watching.
+	 */
+	virtual void Remove(SOCKET s) = 0;
+
+	/**
+	 * Find the watched sockets that are ready, without blocking.
+	 * @param results     Where to store the ready sockets.
+	 * @param max_results The number of elements in \a results.
+	 * @return The number of ready sockets stored in \a results.
+	 */
+	virtual uint Poll(SocketPollResult *results, uint max_results) = 0;
+
+	/**
+	 * Get the number of watched sockets, i.e. the most #Poll can return.
+	 * @return The number of sockets.
+	 */
+	virtual uint GetCount() const = 0;
+
+	/**
+	 * Get the name of the backend, for debugging.
+	 * @return The name.
+	 */
+	virtual const char *GetName() const = 0;
+
+	static SocketPoller *Create();
+};
+
+SocketPollEvents PollSocket(SOCKET s, SocketPollEvents events);
+
+#endif /* ENABLE_NETWORK */
+
+#endif /* NETWORK_CORE_POLLER_H */
@@ -16,7 +16,17 @@
 #include "../../stdafx.h"
 #include "../../debug.h"
 
-#include "tcp.h"
+#include "tcp_io.h"
+
+#if defined(UNIX) && !defined(__OS2__) && !defined(__BEOS__) && !defined(__MORPHOS__) && !defined(__AMIGA__)
+#	include <sys/uio.h>
+#	define WITH_WRITEV
+#endif
+
+/** Maximum number of packets given to the OS in one go. */
+static const uint TCP_SEND_BATCH_SIZE = 64;
+/** When this many packets are waiting, new packets are shrunk as they will have to wait long. */
+static const uint TCP_SEND_QUEUE_SHRINK_LENGTH = 64;
 
 /**
  * Construct a socket handler for a TCP connection.
@@ -24,7 +34,9 @@
  */
 NetworkTCPSocketHandler::NetworkTCPSocketHandler(SOCKET s) :
 		NetworkSocketHandler(),
-		packet_queue(NULL), packet_recv(NULL),
+		packet_queue(NULL), packet_queue_last(NULL), packet_recv(NULL),
+		queued_packets(0), queued_bytes(0),
+		poller(NULL), poller_id(0), io(NULL),
 		sock(s), writable(false)
 {
 }
@@ -33,6 +45,15 @@ NetworkTCPSocketHandler::~NetworkTCPSocketHandler()
 {
 	this->CloseConnection();
 
+	if (this->io != NULL) {
+		/* The network I/O thread sends what is left and closes the socket. */
+		MEMORY_FENCE();
+		this->io->detached = true;
+		this->io = NULL;
+		this->sock = INVALID_SOCKET;
+	}
+
+	this->StopWatching();
 	if (this->sock != INVALID_SOCKET) closesocket(this->sock);
 	this->sock = INVALID_SOCKET;
 }
@@ -48,6 +69,9 @@ NetworkRecvStatus NetworkTCPSocketHandler::CloseConnection(bool error)
 		delete this->packet_queue;
 		this->packet_queue = p;
 	}
+	this->packet_queue_last = NULL;
+	this->queued_packets = 0;
+	this->queued_bytes = 0;
 	delete this->packet_recv;
 	this->packet_recv = NULL;
 
@@ -62,26 +86,54 @@ NetworkRecvStatus NetworkTCPSocketHandler::CloseConnection(bool error)
  */
 void NetworkTCPSocketHandler::SendPacket(Packet *packet)
 {
-	Packet *p;
 	assert(packet != NULL);
 
 	packet->PrepareToSend();
 
-	/* Reallocate the packet as in 99+% of the times we send at most 25 bytes and
-	 * keeping the other 1400+ bytes wastes memory, especially when someone tries
-	 * to do a denial of service attack! */
-	packet->buffer = ReallocT(packet->buffer, packet->size);
+	/* In 99+% of the times we send at most 25 bytes, so keeping the buffer
+	 * of a packet that has to wait long in the queue wastes memory. */
+	if (this->queued_packets >= TCP_SEND_QUEUE_SHRINK_LENGTH) packet->Shrink();
 
-	/* Locate last packet buffered for the client */
-	p = this->packet_queue;
-	if (p == NULL) {
-		/* No packets yet */
+	/* Append the packet to the queue */
+	if (this->packet_queue == NULL) {
 		this->packet_queue = packet;
 	} else {
-		/* Skip to the last packet */
-		while (p->next != NULL) p = p->next;
-		p->next = packet;
+		this->packet_queue_last->next = packet;
+	}
+	this->packet_queue_last = packet;
+	this->queued_packets++;
+	this->queued_bytes += packet->size;
+}
+
+/**
+ * Hand as much of the start of the queue as possible to the OS in one call.
+ * @param sock The socket to send to.
+ * @param queue The first packet to send.
+ * @return The number of bytes sent, or -1 on an error.
+ */
+static ssize_t SendPacketBatch(SOCKET sock, const Packet *queue)
+{
+#if defined(WITH_WRITEV)
+	struct iovec batch[TCP_SEND_BATCH_SIZE];
+	uint count = 0;
+	for (const Packet *p = queue; p != NULL && count < TCP_SEND_BATCH_SIZE; p = p->next, count++) {
+		batch[count].iov_base = p->buffer + p->pos;
+		batch[count].iov_len = p->size - p->pos;
+	}
+	return writev(sock, batch, count);
+#elif defined(WIN32) || defined(WIN64)
+	WSABUF batch[TCP_SEND_BATCH_SIZE];
+	DWORD count = 0;
+	for (const Packet *p = queue; p != NULL && count < TCP_SEND_BATCH_SIZE; p = p->next, count++) {
+		batch[count].buf = (char*)p->buffer + p->pos;
+		batch[count].len = p->size - p->pos;
 	}
+	DWORD sent;
+	if (WSASend(sock, batch, count, &sent, 0, NULL, NULL) == SOCKET_ERROR) return -1;
+	return sent;
+#else
+	return send(sock, (const char*)queue->buffer + queue->pos, queue->size - queue->pos, 0);
+#endif
 }
 
 /**
@@ -90,6 +142,8 @@ void NetworkTCPSocketHandler::SendPacket(Packet *packet)
  *   2) the OS reports back that it can not send any more
  *      data right now (full network-buffer, it happens ;))
  *   3) sending took too long
+ * Many packets are handed to the OS at once, so sending a queue of small
+ * packets does not take a system call for each of them.
  * @param closing_down Whether we are closing down the connection.
  * @return \c true if a (part of a) packet could be sent and
  *         the connection is not closed yet.
@@ -97,25 +151,48 @@ void NetworkTCPSocketHandler::SendPacket(Packet *packet)
 SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 {
 	ssize_t res;
-	Packet *p;
 
 	/* We can not write to this socket!! */
 	if (!this->writable) return SPS_NONE_SENT;
 	if (!this->IsConnected()) return SPS_CLOSED;
 
-	p = this->packet_queue;
-	while (p != NULL) {
-		res = send(this->sock, (const char*)p->buffer + p->pos, p->size - p->pos, 0);
+	if (this->io != NULL) {
+		if (this->io->closed) {
+			if (!closing_down) this->CloseFromIOThread();
+			return SPS_CLOSED;
+		}
+
+		/* Hand the packets to the network I/O thread, which does the actual sending. */
+		while (this->packet_queue != NULL) {
+			Packet *p = this->packet_queue;
+			Packet *next = p->next;
+			p->next = NULL;
+			if (!this->io->outgoing.Push(p)) {
+				p->next = next;
+				return SPS_PARTLY_SENT;
+			}
+
+			this->packet_queue = next;
+			if (next == NULL) this->packet_queue_last = NULL;
+			this->queued_packets--;
+			this->queued_bytes -= p->size;
+		}
+		return SPS_ALL_SENT;
+	}
+
+	while (this->packet_queue != NULL) {
+		res = SendPacketBatch(this->sock, this->packet_queue);
 		if (res == -1) {
 			int err = GET_LAST_ERROR();
 			if (err != EWOULDBLOCK) {
 				/* Something went wrong.. close client! */
 				if (!closing_down) {
-					DEBUG(net, 0, "send failed with error %d", err);
+					this->ReportSocketError("send", err);
 					this->CloseConnection();
 				}
 				return SPS_CLOSED;
 			}
+			this->SetWritable(false);
 			return SPS_PARTLY_SENT;
 		}
 		if (res == 0) {
@@ -124,16 +201,24 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 			return SPS_CLOSED;
 		}
 
-		p->pos += res;
+		this->queued_bytes -= res;
+
+		/* Remove the packets that are sent completely */
+		while (res > 0) {
+			Packet *p = this->packet_queue;
+			ssize_t left = p->size - p->pos;
+			if (res < left) {
+				/* The OS did not take everything; try again when there is room */
+				p->pos += (PacketSize)res;
+				this->SetWritable(false);
+				return SPS_PARTLY_SENT;
+			}
 
-		/* Is this packet sent? */
-		if (p->pos == p->size) {
-			/* Go to the next packet */
+			res -= left;
 			this->packet_queue = p->next;
+			if (this->packet_queue == NULL) this->packet_queue_last = NULL;
+			this->queued_packets--;
 			delete p;
-			p = this->packet_queue;
-		} else {
-			return SPS_PARTLY_SENT;
 		}
 	}
 
@@ -150,6 +235,20 @@ Packet *NetworkTCPSocketHandler::ReceivePacket()
 
 	if (!this->IsConnected()) return NULL;
 
+	if (this->io != NULL) {
+		/* The network I/O thread queues all packets before marking the connection closed. */
+		bool closed = this->io->closed;
+		MEMORY_FENCE();
+
+		Packet *p;
+		if (this->io->incoming.Pop(&p)) {
+			p->cs = this;
+			return p;
+		}
+		if (closed) this->CloseFromIOThread();
+		return NULL;
+	}
+
 	if (this->packet_recv == NULL) {
 		this->packet_recv = new Packet(this);
 	}
@@ -165,7 +264,7 @@ Packet *NetworkTCPSocketHandler::ReceivePacket()
 				int err = GET_LAST_ERROR();
 				if (err != EWOULDBLOCK) {
 					/* Something went wrong... (104 is connection reset by peer) */
-					if (err != 104) DEBUG(net, 0, "recv failed with error %d", err);
+					if (err != 104) this->ReportSocketError("recv", err);
 					this->CloseConnection();
 					return NULL;
 				}
@@ -196,7 +295,7 @@ Packet *NetworkTCPSocketHandler::ReceivePacket()
 			int err = GET_LAST_ERROR();
 			if (err != EWOULDBLOCK) {
 				/* Something went wrong... (104 is connection reset by peer) */
-				if (err != 104) DEBUG(net, 0, "recv failed with error %d", err);
+				if (err != 104) this->ReportSocketError("recv", err);
 				this->CloseConnection();
 				return NULL;
 			}
@@ -226,24 +325,89 @@ Packet *NetworkTCPSocketHandler::ReceivePacket()
  */
 bool NetworkTCPSocketHandler::CanSendReceive()
 {
-	fd_set read_fd, write_fd;
-	struct timeval tv;
+	SocketPollEvents events = PollSocket(this->sock, SPE_READ | SPE_WRITE);
 
-	FD_ZERO(&read_fd);
-	FD_ZERO(&write_fd);
+	this->writable = (events & SPE_WRITE) != 0;
+	return (events & SPE_READ) != 0;
+}
 
-	FD_SET(this->sock, &read_fd);
-	FD_SET(this->sock, &write_fd);
+/**
+ * Let a poller watch this socket, instead of checking it with #CanSendReceive.
+ * The socket is only watched for writing while it is not #writable, so idle
+ * connections do not show up as ready on every poll.
+ * @param poller The poller to watch the socket with.
+ * @param id     Identifier of this socket within the poller.
+ * @return True when the poller watches the socket.
+ */
+bool NetworkTCPSocketHandler::WatchWith(SocketPoller *poller, size_t id)
+{
+	assert(this->poller == NULL && this->io == NULL && this->IsConnected());
 
-	tv.tv_sec = tv.tv_usec = 0; // don't block at all.
-#if !defined(__MORPHOS__) && !defined(__AMIGA__)
-	select(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv);
-#else
-	WaitSelect(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv, NULL);
-#endif
+	if (!poller->Add(this->sock, this->writable ? SPE_READ : SPE_READ | SPE_WRITE, id)) {
+		this->ReportSocketError("poll", GET_LAST_ERROR());
+		return false;
+	}
+	this->poller = poller;
+	this->poller_id = id;
+	return true;
+}
+
+/** Stop the poller from watching this socket, if it does. */
+void NetworkTCPSocketHandler::StopWatching()
+{
+	if (this->poller == NULL) return;
 
-	this->writable = !!FD_ISSET(this->sock, &write_fd);
-	return FD_ISSET(this->sock, &read_fd) != 0;
+	if (this->IsConnected()) this->poller->Remove(this->sock);
+	this->poller = NULL;
+}
+
+/**
+ * Mark whether more data can be sent over this socket.
+ * @param writable Whether the socket can be written to.
+ */
+void NetworkTCPSocketHandler::SetWritable(bool writable)
+{
+	if (this->writable == writable) return;
+	this->writable = writable;
+
+	if (this->poller != NULL && this->IsConnected()) {
+		this->poller->Modify(this->sock, writable ? SPE_READ : SPE_READ | SPE_WRITE, this->poller_id);
+	}
+}
+
+/**
+ * Let the network I/O thread do the reading from and writing to this socket.
+ * Received packets and packets to send are handed over through lock-free
+ * queues; the order of the packets and when they are handled stay the same.
+ * @return True when the network I/O thread handles the socket from now on.
+ */
+bool NetworkTCPSocketHandler::HandOverToIOThread()
+{
+	assert(this->poller == NULL && this->io == NULL && this->IsConnected());
+
+	this->io = NetworkIOChannel::Create(this->sock);
+	if (this->io == NULL) return false;
+
+	/* Whether the socket takes more data is up to the network I/O thread. */
+	this->writable = true;
+	return true;
+}
+
+/** The network I/O thread lost the connection; report why and close it. */
+void NetworkTCPSocketHandler::CloseFromIOThread()
+{
+	if (this->io->error_func != NULL) this->ReportSocketError(this->io->error_func, this->io->error);
+	this->CloseConnection();
+}
+
+/**
+ * Report a failure of a socket function.
+ * @param func The name of the function that failed.
+ * @param err  The error code.
+ */
+/* virtual */ void NetworkTCPSocketHandler::ReportSocketError(const char *func, int err)
+{
+	DEBUG(net, 0, "%s failed with error %d", func, err);
 }
 
 #endif /* ENABLE_NETWORK */
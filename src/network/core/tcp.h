@@ -16,6 +16,7 @@
 
 #include "address.h"
 #include "packet.h"
+#include "poller.h"
 
 #ifdef ENABLE_NETWORK
 
@@ -31,7 +32,17 @@ enum SendPacketsState {
 class NetworkTCPSocketHandler : public NetworkSocketHandler {
 private:
 	Packet *packet_queue;     ///< Packets that are awaiting delivery
+	Packet *packet_queue_last;///< Last packet of #packet_queue, so appending does not need to walk the queue
 	Packet *packet_recv;      ///< Partially received packet
+	uint queued_packets;      ///< Number of packets in #packet_queue
+	size_t queued_bytes;      ///< Number of bytes in #packet_queue that still need to be sent
+	SocketPoller *poller;     ///< Poller watching this socket, if any
+	size_t poller_id;         ///< Identifier of this socket within #poller
+	class NetworkIOChannel *io; ///< The network I/O thread's side of this connection, when that thread handles the socket
+
+	void CloseFromIOThread();
+protected:
+	virtual void ReportSocketError(const char *func, int err);
 public:
 	SOCKET sock;              ///< The socket currently connected to
 	bool writable;            ///< Can we write to this socket?
@@ -42,6 +53,18 @@ public:
 	 */
 	bool IsConnected() const { return this->sock != INVALID_SOCKET; }
 
+	/**
+	 * Get the number of packets awaiting delivery.
+	 * @return The length of the send queue.
+	 */
+	uint GetSendQueueLength() const { return this->queued_packets; }
+
+	/**
+	 * Get the number of bytes awaiting delivery.
+	 * @return The size of the send queue.
+	 */
+	size_t GetSendQueueBytes() const { return this->queued_bytes; }
+
 	virtual NetworkRecvStatus CloseConnection(bool error = true);
 	virtual void SendPacket(Packet *packet);
 	SendPacketsState SendPackets(bool closing_down = false);
@@ -49,6 +72,17 @@ public:
 	virtual Packet *ReceivePacket();
 
 	bool CanSendReceive();
+	bool WatchWith(SocketPoller *poller, size_t id);
+	void StopWatching();
+	void SetWritable(bool writable);
+
+	bool HandOverToIOThread();
+
+	/**
+	 * Whether the network I/O thread does the socket work for this connection.
+	 * @return true when the packets go through the network I/O thread.
+	 */
+	bool IsHandledByIOThread() const { return this->io != NULL; }
 
 	NetworkTCPSocketHandler(SOCKET s = INVALID_SOCKET);
 	~NetworkTCPSocketHandler();
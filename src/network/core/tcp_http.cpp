@@ -22,6 +22,8 @@
 
 /** List of open HTTP connections. */
 static SmallVector<NetworkHTTPSocketHandler *, 1> _http_connections;
+/** Poller watching the open HTTP connections. */
+static SocketPoller *_http_poller = NULL;
 
 /**
  * Start the querying
@@ -63,6 +65,14 @@ NetworkHTTPSocketHandler::NetworkHTTPSocketHandler(SOCKET s,
 		return;
 	}
 
+	if (_http_poller == NULL) _http_poller = SocketPoller::Create();
+	if (!_http_poller->Add(this->sock, SPE_READ, 0)) {
+		/* We would never hear the answer; just fall back to the old system! */
+		DEBUG(net, 0, "[tcp/http] could not watch socket %d", (int)this->sock);
+		this->callback->OnFailure();
+		delete this;
+		return;
+	}
 	*_http_connections.Append() = this;
 }
 
@@ -299,38 +309,27 @@ int NetworkHTTPSocketHandler::Receive()
 	/* No connections, just bail out. */
 	if (_http_connections.Length() == 0) return;
 
-	fd_set read_fd;
-	struct timeval tv;
+	uint max_results = _http_poller->GetCount();
+	SocketPollResult *results = AllocaM(SocketPollResult, max_results);
+	uint n = _http_poller->Poll(results, max_results);
 
-	FD_ZERO(&read_fd);
-	for (NetworkHTTPSocketHandler **iter = _http_connections.Begin(); iter < _http_connections.End(); iter++) {
-		FD_SET((*iter)->sock, &read_fd);
-	}
-
-	tv.tv_sec = tv.tv_usec = 0; // don't block at all.
-#if !defined(__MORPHOS__) && !defined(__AMIGA__)
-	int n = select(FD_SETSIZE, &read_fd, NULL, NULL, &tv);
-#else
-	int n = WaitSelect(FD_SETSIZE, &read_fd, NULL, NULL, &tv, NULL);
-#endif
-	if (n == -1) return;
+	for (uint i = 0; i < n; i++) {
+		/* There are only a few connections, so just look the socket up. */
+		NetworkHTTPSocketHandler **iter = _http_connections.Begin();
+		while (iter != _http_connections.End() && (*iter)->sock != results[i].sock) iter++;
+		if (iter == _http_connections.End()) continue;
 
-	for (NetworkHTTPSocketHandler **iter = _http_connections.Begin(); iter < _http_connections.End(); /* nothing */) {
 		NetworkHTTPSocketHandler *cur = *iter;
-
-		if (FD_ISSET(cur->sock, &read_fd)) {
-			int ret = cur->Receive();
-			/* First send the failure. */
-			if (ret < 0) cur->callback->OnFailure();
-			if (ret <= 0) {
-				/* Then... the connection can be closed */
-				cur->CloseConnection();
-				_http_connections.Erase(iter);
-				delete cur;
-				continue;
-			}
+		int ret = cur->Receive();
+		/* First send the failure. */
+		if (ret < 0) cur->callback->OnFailure();
+		if (ret <= 0) {
+			/* Then... the connection can be closed */
+			_http_poller->Remove(cur->sock);
+			cur->CloseConnection();
+			_http_connections.Erase(iter);
+			delete cur;
 		}
-		iter++;
 	}
 }
 
@@ -0,0 +1,209 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tcp_io.cpp Thread doing the socket work for TCP connections.
+ */
+
+#ifdef ENABLE_NETWORK
+
+#include "../../stdafx.h"
+#include "../../debug.h"
+#include "../../gfx_func.h"
+#include "../../thread/thread.h"
+#include "../../core/smallvec_type.hpp"
+#include "tcp_io.h"
+
+static ThreadObject *_network_io_thread = NULL;                      ///< The network I/O thread, when running.
+static bool _network_io_unavailable = false;                         ///< Whether starting the thread failed before.
+static volatile bool _network_io_exit = false;                       ///< Tells the network I/O thread to stop.
+static ThreadMutex *_network_io_mutex = NULL;                        ///< Guards #_network_io_new_channels.
+static SmallVector<NetworkIOChannel *, 16> _network_io_new_channels; ///< Channels the network I/O thread has not picked up yet.
+
+/**
+ * Create the I/O thread's side of a connection.
+ * @param s The socket of the connection.
+ */
+NetworkIOChannel::NetworkIOChannel(SOCKET s) :
+		NetworkTCPSocketHandler(s),
+		closed(false), detached(false),
+		error_func(NULL), error(0)
+{
+}
+
+/* virtual */ NetworkRecvStatus NetworkIOChannel::CloseConnection(bool error)
+{
+	/* The socket itself is closed once the game thread let go of us. */
+	this->NetworkTCPSocketHandler::CloseConnection(error);
+	this->StopWatching();
+
+	/* All received packets have been queued before this. */
+	MEMORY_FENCE();
+	this->closed = true;
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/* virtual */ void NetworkIOChannel::ReportSocketError(const char *func, int err)
+{
+	/* Logging may send packets to admins, which only the game thread may do. */
+	this->error_func = func;
+	this->error = err;
+}
+
+/**
+ * Free a channel and everything the game thread did not pick up.
+ * @param c The channel to free.
+ */
+static void DeleteNetworkIOChannel(NetworkIOChannel *c)
+{
+	Packet *p;
+	while (c->incoming.Pop(&p)) delete p;
+	while (c->outgoing.Pop(&p)) delete p;
+	delete c;
+}
+
+/**
+ * Main loop of the network I/O thread; does all reading from and writing
+ * to the sockets of the channels until told to stop.
+ */
+static void NetworkIOThreadLoop(void *)
+{
+	SocketPoller *poller = SocketPoller::Create();
+	SmallVector<NetworkIOChannel *, 16> channels; ///< The channels; the index is the identifier in the poller, and free slots are NULL.
+	SmallVector<SocketPollResult, 64> results;
+
+	while (!_network_io_exit) {
+		bool busy = false;
+
+		/* Pick up the new connections. */
+		_network_io_mutex->BeginCritical();
+		for (NetworkIOChannel **iter = _network_io_new_channels.Begin(); iter != _network_io_new_channels.End(); iter++) {
+			NetworkIOChannel **slot = channels.Find(NULL);
+			if (slot == channels.End()) slot = channels.Append();
+			*slot = *iter;
+			if (!(*iter)->WatchWith(poller, slot - channels.Begin())) (*iter)->CloseConnection();
+		}
+		_network_io_new_channels.Clear();
+		_network_io_mutex->EndCritical();
+
+		/* Take the packets the game thread wants to send, and let go
+		 * of the connections the game thread is done with. */
+		for (uint i = 0; i < channels.Length(); i++) {
+			NetworkIOChannel *c = channels[i];
+			if (c == NULL) continue;
+
+			bool detached = c->detached;
+			MEMORY_FENCE();
+
+			Packet *p;
+			while (c->outgoing.Pop(&p)) {
+				if (c->closed) {
+					delete p;
+				} else {
+					c->SendPacket(p);
+				}
+				busy = true;
+			}
+
+			if (!c->closed && c->SendPackets(detached) == SPS_PARTLY_SENT) busy = true;
+
+			if (detached) {
+				DeleteNetworkIOChannel(c);
+				channels[i] = NULL;
+			}
+		}
+
+		/* Receive and send as far as the sockets allow. */
+		uint max_results = poller->GetCount();
+		if (results.Length() < max_results) results.Append(max_results - results.Length());
+		uint n = poller->Poll(results.Begin(), max_results);
+
+		for (uint i = 0; i < n; i++) {
+			NetworkIOChannel *c = channels[results[i].id];
+			if (c == NULL || c->closed) continue;
+
+			if (results[i].events & SPE_WRITE) {
+				c->SetWritable(true);
+				c->SendPackets();
+				busy = true;
+			}
+
+			/* When the game thread lags behind, the data stays in the socket. */
+			if (results[i].events & SPE_READ) {
+				while (!c->closed && !c->incoming.IsFull()) {
+					Packet *p = c->ReceivePacket();
+					if (p == NULL) break;
+					c->incoming.Push(p);
+					busy = true;
+				}
+			}
+		}
+
+		if (!busy) CSleep(1);
+	}
+
+	/* The game thread has closed all connections by now. */
+	for (NetworkIOChannel **iter = channels.Begin(); iter != channels.End(); iter++) {
+		if (*iter != NULL) DeleteNetworkIOChannel(*iter);
+	}
+	_network_io_mutex->BeginCritical();
+	for (NetworkIOChannel **iter = _network_io_new_channels.Begin(); iter != _network_io_new_channels.End(); iter++) {
+		DeleteNetworkIOChannel(*iter);
+	}
+	_network_io_new_channels.Clear();
+	_network_io_mutex->EndCritical();
+
+	delete poller;
+}
+
+/**
+ * Hand a connection over to the network I/O thread, starting the thread if needed.
+ * @param s The socket of the connection.
+ * @return The channel to talk to the thread about the connection, or NULL when there is no thread.
+ */
+/* static */ NetworkIOChannel *NetworkIOChannel::Create(SOCKET s)
+{
+	if (_network_io_thread == NULL) {
+		if (_network_io_unavailable) return NULL;
+
+		if (_network_io_mutex == NULL) _network_io_mutex = ThreadMutex::New();
+		_network_io_exit = false;
+		if (!ThreadObject::New(&NetworkIOThreadLoop, NULL, &_network_io_thread)) {
+			DEBUG(net, 1, "[tcp/io] could not start the network I/O thread, handling sockets on the game thread");
+			_network_io_thread = NULL;
+			_network_io_unavailable = true;
+			return NULL;
+		}
+		DEBUG(net, 3, "[tcp/io] started the network I/O thread");
+	}
+
+	NetworkIOChannel *c = new NetworkIOChannel(s);
+	_network_io_mutex->BeginCritical();
+	*_network_io_new_channels.Append() = c;
+	_network_io_mutex->EndCritical();
+	return c;
+}
+
+/**
+ * Stop the network I/O thread, if it is running.
+ * @pre All connections handled by the thread have been closed.
+ */
+void StopNetworkIOThread()
+{
+	if (_network_io_thread == NULL) return;
+
+	_network_io_exit = true;
+	_network_io_thread->Join();
+	delete _network_io_thread;
+	_network_io_thread = NULL;
+
+	DEBUG(net, 3, "[tcp/io] stopped the network I/O thread");
+}
+
+#endif /* ENABLE_NETWORK */
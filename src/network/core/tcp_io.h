@@ -0,0 +1,54 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tcp_io.h Thread doing the socket work for TCP connections.
+ */
+
+#ifndef NETWORK_CORE_TCP_IO_H
+#define NETWORK_CORE_TCP_IO_H
+
+#include "tcp.h"
+#include "../../thread/spsc_queue.hpp"
+
+#ifdef ENABLE_NETWORK
+
+/** Number of slots in each of the packet queues between the threads. */
+static const uint NETWORK_IO_QUEUE_SIZE = 256;
+
+/**
+ * The part of a TCP connection that lives on the network I/O thread.
+ * It owns the socket, assembles received packets and sends queued packets.
+ * The game thread only talks to it through the packet queues and flags.
+ */
+class NetworkIOChannel : public NetworkTCPSocketHandler {
+public:
+	SPSCQueue<Packet *, NETWORK_IO_QUEUE_SIZE> incoming; ///< Received packets, from the I/O thread to the game thread.
+	SPSCQueue<Packet *, NETWORK_IO_QUEUE_SIZE> outgoing; ///< Packets to send, from the game thread to the I/O thread.
+
+	volatile bool closed;      ///< Set by the I/O thread when the connection is lost; nothing will be received anymore.
+	volatile bool detached;    ///< Set by the game thread when it is done with the connection.
+	const char *error_func;    ///< The socket function that failed when the connection was lost, if any.
+	int error;                 ///< The error of #error_func.
+
+	NetworkIOChannel(SOCKET s);
+
+	/* virtual */ NetworkRecvStatus CloseConnection(bool error = true);
+
+	static NetworkIOChannel *Create(SOCKET s);
+
+protected:
+	/* virtual */ void ReportSocketError(const char *func, int err);
+};
+
+void StopNetworkIOThread();
+
+#endif /* ENABLE_NETWORK */
+
+#endif /* NETWORK_CORE_TCP_IO_H */
@@ -18,6 +18,7 @@
 #include "../network.h"
 #include "../../core/pool_type.hpp"
 #include "../../debug.h"
+#include "../../settings_type.h"
 #include "table/strings.h"
 
 #ifdef ENABLE_NETWORK
@@ -32,6 +33,36 @@ template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet>
 class TCPListenHandler {
 	/** List of sockets we listen on. */
 	static SocketList sockets;
+	/** Poller watching the listening sockets and the accepted connections. */
+	static SocketPoller *poller;
+
+	/**
+	 * Get the poller for our sockets, creating it when needed.
+	 * It is kept around after closing the listeners, as connections
+	 * (e.g. admins) may outlive them.
+	 * @return The poller.
+	 */
+	static SocketPoller *GetPoller()
+	{
+		if (poller == NULL) {
+			poller = SocketPoller::Create();
+			DEBUG(net, 1, "[%s] using %s to poll sockets", Tsocket::GetName(), poller->GetName());
+		}
+		return poller;
+	}
+
+	/**
+	 * Check whether a socket is one we listen on.
+	 * @param s The socket to check.
+	 * @return True when it is a listening socket.
+	 */
+	static bool IsListener(SOCKET s)
+	{
+		for (SocketList::iterator iter = sockets.Begin(); iter != sockets.End(); iter++) {
+			if (iter->second == s) return true;
+		}
+		return false;
+	}
 
 public:
 	/**
@@ -85,7 +116,13 @@ public:
 				continue;
 			}
 
-			Tsocket::AcceptConnection(s, address);
+			Tsocket *cs = Tsocket::AcceptConnection(s, address);
+			if (_settings_client.network.io_thread && cs->HandOverToIOThread()) continue;
+			if (!cs->WatchWith(GetPoller(), cs->index)) {
+				/* We would never hear from this client; do not keep its slot. */
+				DEBUG(net, 1, "[%s] Could not watch the socket of a new client", Tsocket::GetName());
+				static_cast<NetworkTCPSocketHandler *>(cs)->CloseConnection();
+			}
 		}
 	}
 
@@ -95,42 +132,33 @@ public:
 	 */
 	static bool Receive()
 	{
-		fd_set read_fd, write_fd;
-		struct timeval tv;
-
-		FD_ZERO(&read_fd);
-		FD_ZERO(&write_fd);
+		SocketPoller *poller = GetPoller();
 
+		/* Only sockets that are ready are returned, so there is
+		 * no need to go over all connections. */
+		uint max_results = poller->GetCount();
+		SocketPollResult *results = AllocaM(SocketPollResult, max(max_results, 1U));
+		uint n = poller->Poll(results, max_results);
 
-		Tsocket *cs;
-		FOR_ALL_ITEMS_FROM(Tsocket, idx, cs, 0) {
-			FD_SET(cs->sock, &read_fd);
-			FD_SET(cs->sock, &write_fd);
-		}
-
-		/* take care of listener port */
-		for (SocketList::iterator s = sockets.Begin(); s != sockets.End(); s++) {
-			FD_SET(s->second, &read_fd);
+		/* accept clients.. */
+		for (uint i = 0; i < n; i++) {
+			if (IsListener(results[i].sock)) AcceptClient(results[i].sock);
 		}
 
-		tv.tv_sec = tv.tv_usec = 0; // don't block at all.
-#if !defined(__MORPHOS__) && !defined(__AMIGA__)
-		select(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv);
-#else
-		WaitSelect(FD_SETSIZE, &read_fd, &write_fd, NULL, &tv, NULL);
-#endif
+		/* read stuff from clients */
+		for (uint i = 0; i < n; i++) {
+			/* Handling an earlier client might have closed this one. */
+			Tsocket *cs = Tsocket::GetIfValid(results[i].id);
+			if (cs == NULL || cs->sock != results[i].sock) continue;
 
-		/* accept clients.. */
-		for (SocketList::iterator s = sockets.Begin(); s != sockets.End(); s++) {
-			if (FD_ISSET(s->second, &read_fd)) AcceptClient(s->second);
+			if (results[i].events & SPE_WRITE) cs->SetWritable(true);
+			if (results[i].events & SPE_READ) cs->ReceivePackets();
 		}
 
-		/* read stuff from clients */
+		/* The connections of the network I/O thread are not in the poller. */
+		Tsocket *cs;
 		FOR_ALL_ITEMS_FROM(Tsocket, idx, cs, 0) {
-			cs->writable = !!FD_ISSET(cs->sock, &write_fd);
-			if (FD_ISSET(cs->sock, &read_fd)) {
-				cs->ReceivePackets();
-			}
+			if (cs->IsHandledByIOThread()) cs->ReceivePackets();
 		}
 		return _networking;
 	}
@@ -151,6 +179,10 @@ public:
 			address->Listen(SOCK_STREAM, &sockets);
 		}
 
+		for (SocketList::iterator s = sockets.Begin(); s != sockets.End(); s++) {
+			GetPoller()->Add(s->second, SPE_READ, 0);
+		}
+
 		if (sockets.Length() == 0) {
 			DEBUG(net, 0, "[server] could not start network: could not create listening socket");
 			NetworkError(STR_NETWORK_ERROR_SERVER_START);
@@ -164,6 +196,7 @@ public:
 	static void CloseListeners()
 	{
 		for (SocketList::iterator s = sockets.Begin(); s != sockets.End(); s++) {
+			GetPoller()->Remove(s->second);
 			closesocket(s->second);
 		}
 		sockets.Clear();
@@ -172,6 +205,7 @@ public:
 };
 
 template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> SocketList TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::sockets;
+template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> SocketPoller *TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::poller = NULL;
 
 #endif /* ENABLE_NETWORK */
 
@@ -25,6 +25,7 @@
 #include "network_base.h"
 #include "core/udp.h"
 #include "core/host.h"
+#include "core/tcp_io.h"
 #include "network_gui.h"
 #include "../console_func.h"
 #include "../3rdparty/md5/md5.h"
@@ -76,6 +77,8 @@ uint32 _sync_seed_1;                  ///< Seed to compare during sync checks.
 uint32 _sync_seed_2;                  ///< Second part of the seed.
 #endif
 uint32 _sync_frame;                   ///< The frame to perform the sync check.
+StateHashes _sync_state_hashes;       ///< Hashes of the game state to compare during sync checks.
+bool _sync_state_hashes_valid;        ///< Whether #_sync_state_hashes are known; older servers do not send them.
 bool _network_first_time;             ///< Whether we have finished joining or not.
 bool _network_udp_server;             ///< Is the UDP server started?
 uint16 _network_udp_broadcast;        ///< Timeout for the UDP broadcasts.
@@ -483,8 +486,9 @@ void ParseConnectionString(const char **company, const char **port, char *connec
  * Handle the acception of a connection to the server.
  * @param s The socket of the new connection.
  * @param address The address of the peer.
+ * @return The handler of the new connection.
  */
-/* static */ void ServerNetworkGameSocketHandler::AcceptConnection(SOCKET s, const NetworkAddress &address)
+/* static */ ServerNetworkGameSocketHandler *ServerNetworkGameSocketHandler::AcceptConnection(SOCKET s, const NetworkAddress &address)
 {
 	/* Register the login */
 	_network_clients_connected++;
@@ -492,6 +496,7 @@ void ParseConnectionString(const char **company, const char **port, char *connec
 	SetWindowDirty(WC_CLIENT_LIST, 0);
 	ServerNetworkGameSocketHandler *cs = new ServerNetworkGameSocketHandler(s);
 	cs->client_address = address; // Save the IP of the client
+	return cs;
 }
 
 /**
@@ -548,6 +553,7 @@ static void NetworkInitialize(bool close_admins = true)
 	NetworkUDPInitialize();
 
 	_sync_frame = 0;
+	_sync_state_hashes_valid = false;
 	_network_first_time = true;
 
 	_network_reconnect = 0;
@@ -1062,6 +1068,7 @@ void NetworkShutDown()
 {
 	NetworkDisconnect(true);
 	NetworkUDPClose();
+	StopNetworkIOThread();
 
 	DEBUG(net, 3, "[core] shutting down network");
 
@@ -69,7 +69,7 @@ public:
 	NetworkRecvStatus SendCmdLogging(ClientID client_id, const CommandPacket *cp);
 
 	static void Send();
-	static void AcceptConnection(SOCKET s, const NetworkAddress &address);
+	static ServerNetworkAdminSocketHandler *AcceptConnection(SOCKET s, const NetworkAddress &address);
 	static bool AllowConnection();
 	static void WelcomeAll();
 
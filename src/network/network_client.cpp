@@ -230,6 +230,32 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 	my_client->CheckConnection();
 }
 
+/**
+ * Compare the hashes of our game state with the ones of the server at a sync
+ * frame, and log the parts of the game state that differ. The hashes of all
+ * objects of those parts are written to the desync log, so comparing it with
+ * the log of the server shows which object differs.
+ * @return False if any part of the game state differs.
+ */
+static bool CheckStateHashes()
+{
+	if (!_sync_state_hashes_valid) return true;
+
+	StateHashes hashes;
+	CalculateStateHashes(&hashes, _frame_counter);
+
+	bool in_sync = true;
+	for (StateHashType type = SHT_BEGIN; type < SHT_END; type++) {
+		if (hashes.hash[type] == _sync_state_hashes.hash[type]) continue;
+
+		DEBUG(net, 0, "Game state differs from the server: %s (%08x instead of %08x)", GetStateHashName(type), hashes.hash[type], _sync_state_hashes.hash[type]);
+		DEBUG(desync, 1, "hash_err: %08x; %02x; %s", _date, _date_fract, GetStateHashName(type));
+		LogStateHash(type, _frame_counter);
+		in_sync = false;
+	}
+	return in_sync;
+}
+
 /**
  * Actual game loop for the client.
  * @return Whether everything went okay, or not.
@@ -254,6 +280,16 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 				NetworkError(STR_NETWORK_ERROR_DESYNC);
 				DEBUG(desync, 1, "sync_err: %08x; %02x", _date, _date_fract);
 				DEBUG(net, 0, "Sync error detected!");
+				CheckStateHashes();
+				my_client->ClientError(NETWORK_RECV_STATUS_DESYNC);
+				return false;
+			}
+
+			/* The random state can be fine while the rest of the game state is not. */
+			if (!CheckStateHashes()) {
+				NetworkError(STR_NETWORK_ERROR_DESYNC);
+				DEBUG(desync, 1, "sync_err: %08x; %02x", _date, _date_fract);
+				DEBUG(net, 0, "Sync error detected in the game state!");
 				my_client->ClientError(NETWORK_RECV_STATUS_DESYNC);
 				return false;
 			}
@@ -920,6 +956,14 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_SYNC(Packet *p)
 	_sync_seed_2 = p->Recv_uint32();
 #endif
 
+	/* Older servers do not send the hashes of the game state. */
+	_sync_state_hashes_valid = p->pos < p->size;
+	if (_sync_state_hashes_valid) {
+		for (StateHashType type = SHT_BEGIN; type < SHT_END; type++) {
+			_sync_state_hashes.hash[type] = p->Recv_uint32();
+		}
+	}
+
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
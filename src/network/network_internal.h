@@ -16,6 +16,7 @@
 #include "core/tcp_game.h"
 
 #include "../command_type.h"
+#include "../state_hash.h"
 
 #ifdef ENABLE_NETWORK
 
@@ -120,6 +121,8 @@ extern uint32 _sync_seed_1;
 extern uint32 _sync_seed_2;
 #endif
 extern uint32 _sync_frame;
+extern StateHashes _sync_state_hashes;
+extern bool _sync_state_hashes_valid;
 extern bool _network_first_time;
 /* Vars needed for the join-GUI */
 extern NetworkJoinStatus _network_join_status;
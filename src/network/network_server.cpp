@@ -57,13 +57,14 @@ template SocketList TCPListenHandler<ServerNetworkGameSocketHandler, PACKET_SERV
 struct PacketWriter : SaveFilter {
 	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
 	Packet *current;                    ///< The packet we're currently writing to.
+	Packet *last;                       ///< The last packet appended to the savegame queue.
 	size_t total_size;                  ///< Total size of the compressed savegame.
 
 	/**
 	 * Create the packet writer.
 	 * @param cs The socket handler we're making the packets for.
 	 */
-	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(NULL), cs(cs), current(NULL), total_size(0)
+	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(NULL), cs(cs), current(NULL), last(NULL), total_size(0)
 	{
 		this->cs->savegame_mutex = ThreadMutex::New();
 	}
@@ -89,11 +90,14 @@ struct PacketWriter : SaveFilter {
 	{
 		if (this->current == NULL) return;
 
-		Packet **p = &this->cs->savegame_packets;
-		while (*p != NULL) {
-			p = &(*p)->next;
+		/* Packets are only taken from the front of the queue, so if the
+		 * queue is not empty the last packet we appended is still in it. */
+		if (this->cs->savegame_packets == NULL) {
+			this->cs->savegame_packets = this->current;
+		} else {
+			this->last->next = this->current;
 		}
-		*p = this->current;
+		this->last = this->current;
 
 		this->current = NULL;
 	}
@@ -662,6 +666,23 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendFrame()
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/** Make sure #_sync_state_hashes are the ones of the current frame. */
+static void UpdateSyncStateHashes()
+{
+	static uint32 hashed_frame; ///< The frame #_sync_state_hashes belong to.
+
+	if (_sync_state_hashes_valid && hashed_frame == _frame_counter) return;
+
+	CalculateStateHashes(&_sync_state_hashes, _frame_counter);
+	_sync_state_hashes_valid = true;
+	hashed_frame = _frame_counter;
+
+	if (_debug_desync_level >= 2) {
+		/* Allow finding the object that differs when a client reports a desync. */
+		for (StateHashType type = SHT_BEGIN; type < SHT_END; type++) LogStateHash(type, _frame_counter);
+	}
+}
+
 /** Request the client to sync. */
 NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync()
 {
@@ -672,6 +693,11 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync()
 #ifdef NETWORK_SEND_DOUBLE_SEED
 	p->Send_uint32(_sync_seed_2);
 #endif
+	/* Older clients ignore these. */
+	UpdateSyncStateHashes();
+	for (StateHashType type = SHT_BEGIN; type < SHT_END; type++) {
+		p->Send_uint32(_sync_state_hashes.hash[type]);
+	}
 	this->SendPacket(p);
 	return NETWORK_RECV_STATUS_OKAY;
 }
@@ -1920,10 +1946,10 @@ void NetworkServerShowStatusToConsole()
 		const char *status;
 
 		status = (cs->status < (ptrdiff_t)lengthof(stat_str) ? stat_str[cs->status] : "unknown");
-		IConsolePrintF(CC_INFO, "Client #%1d  name: '%s'  status: '%s'  frame-lag: %3d  company: %1d  IP: %s",
+		IConsolePrintF(CC_INFO, "Client #%1d  name: '%s'  status: '%s'  frame-lag: %3d  company: %1d  IP: %s  send-queue: %d packets, %d bytes",
 			cs->client_id, ci->client_name, status, lag,
 			ci->client_playas + (Company::IsValidID(ci->client_playas) ? 1 : 0),
-			cs->GetClientIP());
+			cs->GetClientIP(), cs->GetSendQueueLength(), (int)cs->GetSendQueueBytes());
 	}
 }
 
@@ -107,7 +107,7 @@ public:
 	NetworkRecvStatus SendConfigUpdate();
 
 	static void Send();
-	static void AcceptConnection(SOCKET s, const NetworkAddress &address);
+	static ServerNetworkGameSocketHandler *AcceptConnection(SOCKET s, const NetworkAddress &address);
 	static bool AllowConnection();
 
 	/**
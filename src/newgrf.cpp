@@ -8277,6 +8277,9 @@ static void AfterLoadGRFs()
 	}
 	_string_to_grf_mapping.clear();
 
+	/* Town and station names may come from the NewGRFs. */
+	InvalidateNameCache();
+
 	/* Free the action 6 override sprites. */
 	for (GRFLineToSpriteOverride::iterator it = _grf_line_to_action6_sprite_override.begin(); it != _grf_line_to_action6_sprite_override.end(); it++) {
 		free((*it).second);
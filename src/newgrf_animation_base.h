@@ -50,7 +50,13 @@ struct AnimationBase {
 		 * increasing this value by one doubles the wait. 0 is the minimum value
 		 * allowed for animation_speed, which corresponds to 30ms, and 16 is the
 		 * maximum, corresponding to around 33 minutes. */
-		if (_tick_counter % (1 << animation_speed) != 0) return;
+		if (_tick_counter % (1 << animation_speed) != 0) {
+			/* Without the callback the speed is fixed, so nothing happens until the next frame is due. */
+			if (!HasBit(spec->callback_mask, Tbase::cbm_animation_speed)) {
+				SetAnimatedTileDelay(tile, (1 << animation_speed) - _tick_counter % (1 << animation_speed));
+			}
+			return;
+		}
 
 		uint8 frame      = GetAnimationFrame(tile);
 		uint8 num_frames = spec->animation.frames;
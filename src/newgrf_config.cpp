@@ -20,6 +20,11 @@
 
 #include "fileio_func.h"
 #include "fios.h"
+#include "tar_type.h"
+#include "string_func.h"
+#include "core/endian_func.hpp"
+#include "thread/thread.h"
+#include <sys/stat.h>
 
 /** Create a new GRFTextWrapper. */
 GRFTextWrapper::GRFTextWrapper() :
@@ -307,12 +312,12 @@ static bool CalcGRFMD5Sum(GRFConfig *config)
 
 
 /**
- * Find the GRFID of a given grf, and calculate its md5sum.
+ * Find the GRFID and the other details of a given grf, but do not calculate its md5sum.
  * @param config    grf to fill.
  * @param is_static grf is static.
  * @return Operation was successfully completed.
  */
-bool FillGRFDetails(GRFConfig *config, bool is_static)
+static bool ReadGRFDetails(GRFConfig *config, bool is_static)
 {
 	if (!FioCheckFileExists(config->filename)) {
 		config->status = GCS_NOT_FOUND;
@@ -334,7 +339,18 @@ bool FillGRFDetails(GRFConfig *config, bool is_static)
 		if (HasBit(config->flags, GCF_UNSAFE)) return false;
 	}
 
-	return CalcGRFMD5Sum(config);
+	return true;
+}
+
+/**
+ * Find the GRFID of a given grf, and calculate its md5sum.
+ * @param config    grf to fill.
+ * @param is_static grf is static.
+ * @return Operation was successfully completed.
+ */
+bool FillGRFDetails(GRFConfig *config, bool is_static)
+{
+	return ReadGRFDetails(config, is_static) && CalcGRFMD5Sum(config);
 }
 
 
@@ -525,59 +541,499 @@ compatible_grf:
 	return res;
 }
 
+/** Result of scanning a single NewGRF file, as stored in the NewGRF scan cache. */
+struct GRFScanCacheEntry {
+	uint64 size;       ///< Size of the file when it was scanned.
+	uint64 mtime;      ///< Modification time of the file, or of the tar containing it, when it was scanned.
+	GRFConfig *config; ///< Details of the NewGRF, or \c NULL when the file is not a usable NewGRF.
+};
+
+/** Scan results of NewGRF files, by the full path of the file. */
+typedef std::map<std::string, GRFScanCacheEntry> GRFScanCache;
+
+static GRFScanCache _grf_scan_cache;        ///< Results of the previous scan.
+static bool _grf_scan_cache_loaded = false; ///< Whether the results of the scan of a previous run have been read from disk.
+
+static const uint32 GRF_SCAN_CACHE_ID      = 0x43464E47; ///< Identifier at the start of the scan cache file.
+static const uint32 GRF_SCAN_CACHE_VERSION = 1;          ///< Version of the scan cache file; increase it when the format or the scanned details change.
+#if defined(WIN32)
+static const uint GRF_MD5_THREADS          = 0;          ///< Opening files uses the static buffer of OTTD2FS, so calculate the md5sums on the main thread.
+#else
+static const uint GRF_MD5_THREADS          = 4;          ///< Number of threads calculating the md5sums of changed NewGRFs.
+#endif
+
+/**
+ * Free the NewGRF details of a scan cache.
+ * @param cache The cache to clear.
+ */
+static void ClearGRFScanCache(GRFScanCache &cache)
+{
+	for (GRFScanCache::iterator it = cache.begin(); it != cache.end(); it++) {
+		delete it->second.config;
+	}
+	cache.clear();
+}
+
+/**
+ * Get the name of the file the scan cache is stored in.
+ * @return The name of the file; it must be freed by the caller.
+ */
+static char *GetGRFScanCacheFilename()
+{
+	return str_fmt("%snewgrf_cache.dat", _personal_dir);
+}
+
+/**
+ * Get the size and the modification time of a NewGRF file, to find out whether it changed since it was scanned.
+ * @param filename    Full path of the file, or the name of the file inside a tar.
+ * @param size [out]  Size of the file.
+ * @param mtime [out] Modification time of the file, or of the tar containing it.
+ * @return Whether the file could be found.
+ */
+static bool GetGRFFileStamp(const char *filename, uint64 *size, uint64 *mtime)
+{
+#ifdef WIN32
+	struct _stat sb;
+	if (_tstat(OTTD2FS(filename), &sb) == 0) {
+#else
+	struct stat sb;
+	if (stat(filename, &sb) == 0) {
+#endif
+		*size = sb.st_size;
+		*mtime = sb.st_mtime;
+		return true;
+	}
+
+	TarFileList::const_iterator it = _tar_filelist.find(filename);
+	if (it == _tar_filelist.end()) return false;
+
+#ifdef WIN32
+	if (_tstat(OTTD2FS(it->second.tar_filename), &sb) != 0) return false;
+#else
+	if (stat(it->second.tar_filename, &sb) != 0) return false;
+#endif
+	*size = it->second.size;
+	*mtime = sb.st_mtime;
+	return true;
+}
+
+/**
+ * Write a 32 bits value to the scan cache.
+ * @param f     File to write to.
+ * @param value Value to write.
+ */
+static void WriteGRFScanCacheValue(FILE *f, uint32 value)
+{
+	value = TO_LE32(value);
+	fwrite(&value, sizeof(value), 1, f);
+}
+
+/**
+ * Read a 32 bits value from the scan cache.
+ * @param f           File to read from.
+ * @param value [out] The read value.
+ * @return Whether the value could be read.
+ */
+static bool ReadGRFScanCacheValue(FILE *f, uint32 *value)
+{
+	if (fread(value, sizeof(*value), 1, f) != 1) return false;
+	*value = FROM_LE32(*value);
+	return true;
+}
+
+/**
+ * Write a 64 bits value to the scan cache.
+ * @param f     File to write to.
+ * @param value Value to write.
+ */
+static void WriteGRFScanCacheValue(FILE *f, uint64 value)
+{
+	WriteGRFScanCacheValue(f, (uint32)GB(value, 0, 32));
+	WriteGRFScanCacheValue(f, (uint32)GB(value, 32, 32));
+}
+
+/**
+ * Read a 64 bits value from the scan cache.
+ * @param f           File to read from.
+ * @param value [out] The read value.
+ * @return Whether the value could be read.
+ */
+static bool ReadGRFScanCacheValue(FILE *f, uint64 *value)
+{
+	uint32 low, high;
+	if (!ReadGRFScanCacheValue(f, &low) || !ReadGRFScanCacheValue(f, &high)) return false;
+	*value = ((uint64)high << 32) | low;
+	return true;
+}
+
+/**
+ * Write the details of a scanned NewGRF to the scan cache.
+ * @param f File to write to.
+ * @param c The scanned NewGRF.
+ */
+static void SaveGRFScanDetails(FILE *f, const GRFConfig *c)
+{
+	WriteGRFScanCacheValue(f, c->ident.grfid);
+	fwrite(c->ident.md5sum, 1, sizeof(c->ident.md5sum), f);
+	WriteGRFScanCacheValue(f, c->version);
+	WriteGRFScanCacheValue(f, c->min_loadable_version);
+	byte values[] = { c->flags, (byte)c->status, c->palette, c->num_valid_params, c->has_param_defaults };
+	fwrite(values, 1, sizeof(values), f);
+	SaveGRFTextList(f, c->name->text);
+	SaveGRFTextList(f, c->info->text);
+
+	WriteGRFScanCacheValue(f, (uint32)c->param_info.Length());
+	for (const GRFParameterInfo * const *it = c->param_info.Begin(); it != c->param_info.End(); it++) {
+		const GRFParameterInfo *info = *it;
+		byte present = info != NULL;
+		fwrite(&present, 1, 1, f);
+		if (info == NULL) continue;
+
+		SaveGRFTextList(f, info->name);
+		SaveGRFTextList(f, info->desc);
+		WriteGRFScanCacheValue(f, (uint32)info->type);
+		WriteGRFScanCacheValue(f, info->min_value);
+		WriteGRFScanCacheValue(f, info->max_value);
+		WriteGRFScanCacheValue(f, info->def_value);
+		byte bits[] = { info->param_nr, info->first_bit, info->num_bit };
+		fwrite(bits, 1, sizeof(bits), f);
+
+		WriteGRFScanCacheValue(f, (uint32)info->value_names.Length());
+		for (const SmallPair<uint32, GRFText *> *name = info->value_names.Begin(); name != info->value_names.End(); name++) {
+			WriteGRFScanCacheValue(f, name->first);
+			SaveGRFTextList(f, name->second);
+		}
+	}
+}
+
+/**
+ * Read the details of a scanned NewGRF from the scan cache.
+ * @param f File to read from.
+ * @param c The NewGRF to fill.
+ * @return Whether the details could be read.
+ */
+static bool LoadGRFScanDetails(FILE *f, GRFConfig *c)
+{
+	uint32 type, count;
+	byte values[5];
+	if (!ReadGRFScanCacheValue(f, &c->ident.grfid)) return false;
+	if (fread(c->ident.md5sum, 1, sizeof(c->ident.md5sum), f) != sizeof(c->ident.md5sum)) return false;
+	if (!ReadGRFScanCacheValue(f, &c->version) || !ReadGRFScanCacheValue(f, &c->min_loadable_version)) return false;
+	if (fread(values, 1, sizeof(values), f) != sizeof(values)) return false;
+	c->flags              = values[0];
+	c->status             = (GRFStatus)values[1];
+	c->palette            = values[2];
+	c->num_valid_params   = values[3];
+	c->has_param_defaults = values[4] != 0;
+	if (!LoadGRFTextList(f, &c->name->text) || !LoadGRFTextList(f, &c->info->text)) return false;
+
+	if (!ReadGRFScanCacheValue(f, &count) || count > lengthof(c->param)) return false;
+	for (; count > 0; count--) {
+		byte present;
+		if (fread(&present, 1, 1, f) != 1) return false;
+		if (present == 0) {
+			*c->param_info.Append() = NULL;
+			continue;
+		}
+
+		GRFParameterInfo *info = new GRFParameterInfo(0);
+		*c->param_info.Append() = info;
+
+		byte bits[3];
+		if (!LoadGRFTextList(f, &info->name) || !LoadGRFTextList(f, &info->desc)) return false;
+		if (!ReadGRFScanCacheValue(f, &type) || type >= PTYPE_END) return false;
+		info->type = (GRFParameterType)type;
+		if (!ReadGRFScanCacheValue(f, &info->min_value) || !ReadGRFScanCacheValue(f, &info->max_value) || !ReadGRFScanCacheValue(f, &info->def_value)) return false;
+		if (fread(bits, 1, sizeof(bits), f) != sizeof(bits)) return false;
+		info->param_nr  = bits[0];
+		info->first_bit = bits[1];
+		info->num_bit   = bits[2];
+
+		uint32 num_names;
+		if (!ReadGRFScanCacheValue(f, &num_names)) return false;
+		for (; num_names > 0; num_names--) {
+			uint32 value;
+			GRFText *name;
+			if (!ReadGRFScanCacheValue(f, &value)) return false;
+			bool ok = LoadGRFTextList(f, &name);
+			info->value_names.Insert(value, name);
+			if (!ok) return false;
+		}
+	}
+	return true;
+}
+
+/** Read the results of the NewGRF scan of a previous run from disk. */
+static void LoadGRFScanCache()
+{
+	_grf_scan_cache_loaded = true;
+
+	char *filename = GetGRFScanCacheFilename();
+	FILE *f = fopen(filename, "rb");
+	free(filename);
+	if (f == NULL) return;
+
+	uint32 id, version, count;
+	bool ok = ReadGRFScanCacheValue(f, &id) && id == GRF_SCAN_CACHE_ID &&
+			ReadGRFScanCacheValue(f, &version) && version == GRF_SCAN_CACHE_VERSION &&
+			ReadGRFScanCacheValue(f, &count);
+
+	for (; ok && count > 0; count--) {
+		uint32 length;
+		if (!ReadGRFScanCacheValue(f, &length) || length >= MAX_PATH) {
+			ok = false;
+			break;
+		}
+
+		char path[MAX_PATH];
+		GRFScanCacheEntry entry;
+		byte valid;
+		if (fread(path, 1, length, f) != length || !ReadGRFScanCacheValue(f, &entry.size) ||
+				!ReadGRFScanCacheValue(f, &entry.mtime) || fread(&valid, 1, 1, f) != 1) {
+			ok = false;
+			break;
+		}
+		path[length] = '\0';
+
+		entry.config = NULL;
+		if (valid != 0) {
+			entry.config = new GRFConfig();
+			if (!LoadGRFScanDetails(f, entry.config)) {
+				delete entry.config;
+				ok = false;
+				break;
+			}
+		}
+
+		std::pair<GRFScanCache::iterator, bool> res = _grf_scan_cache.insert(std::make_pair(std::string(path), entry));
+		if (!res.second) delete entry.config;
+	}
+	fclose(f);
+
+	if (!ok) {
+		DEBUG(grf, 1, "NewGRF scan cache is invalid, scanning all NewGRFs");
+		ClearGRFScanCache(_grf_scan_cache);
+	} else {
+		DEBUG(grf, 2, "Read %d entries from the NewGRF scan cache", (int)_grf_scan_cache.size());
+	}
+}
+
+/** Write the results of the last NewGRF scan to disk, so the next run only has to scan changed NewGRFs. */
+static void SaveGRFScanCache()
+{
+	char *filename = GetGRFScanCacheFilename();
+	FILE *f = fopen(filename, "wb");
+	free(filename);
+	if (f == NULL) return;
+
+	WriteGRFScanCacheValue(f, GRF_SCAN_CACHE_ID);
+	WriteGRFScanCacheValue(f, GRF_SCAN_CACHE_VERSION);
+	WriteGRFScanCacheValue(f, (uint32)_grf_scan_cache.size());
+	for (GRFScanCache::const_iterator it = _grf_scan_cache.begin(); it != _grf_scan_cache.end(); it++) {
+		WriteGRFScanCacheValue(f, (uint32)it->first.length());
+		fwrite(it->first.c_str(), 1, it->first.length(), f);
+		WriteGRFScanCacheValue(f, it->second.size);
+		WriteGRFScanCacheValue(f, it->second.mtime);
+		byte valid = it->second.config != NULL;
+		fwrite(&valid, 1, 1, f);
+		if (it->second.config != NULL) SaveGRFScanDetails(f, it->second.config);
+	}
+	fclose(f);
+}
+
+/** A usable NewGRF found by the scanner, to be added to #_all_grfs. */
+struct GRFScanResult {
+	GRFConfig *config;              ///< The details of the NewGRF.
+	GRFScanCache::iterator cache_entry; ///< Entry in the new scan cache, or the end of it when the NewGRF can not be cached.
+	bool needs_md5sum;              ///< The md5sum is not known yet.
+	bool valid;                     ///< The md5sum could be calculated.
+};
+
+/** Work of the threads calculating the md5sums of scanned NewGRFs. */
+struct GRFMD5SumWork {
+	GRFScanResult *results; ///< The scanned NewGRFs.
+	uint count;             ///< Number of scanned NewGRFs.
+	uint next;              ///< Index of the next NewGRF to handle.
+	ThreadMutex *mutex;     ///< Mutex protecting #next.
+};
+
+/**
+ * Calculate the md5sums of scanned NewGRFs, until there are no NewGRFs left.
+ * Several of these run in parallel, each picking the next NewGRF from the shared work.
+ * @param param The #GRFMD5SumWork.
+ */
+static void CalcGRFMD5SumsThread(void *param)
+{
+	GRFMD5SumWork *work = (GRFMD5SumWork *)param;
+	for (;;) {
+		work->mutex->BeginCritical();
+		uint i = work->next++;
+		work->mutex->EndCritical();
+		if (i >= work->count) return;
+
+		GRFScanResult *result = &work->results[i];
+		if (result->needs_md5sum) result->valid = CalcGRFMD5Sum(result->config);
+	}
+}
+
 /** Helper for scanning for files with GRF as extension */
 class GRFFileScanner : FileScanner {
+	SmallVector<GRFScanResult, 32> results; ///< The usable NewGRFs that were found.
+	GRFScanCache cache;                     ///< Cache with the results of this scan.
+
+	void CalcMD5Sums();
+	uint AddResults();
+
 public:
+	~GRFFileScanner()
+	{
+		for (GRFScanResult *result = this->results.Begin(); result != this->results.End(); result++) {
+			delete result->config;
+		}
+		ClearGRFScanCache(this->cache);
+	}
+
 	/* virtual */ bool AddFile(const char *filename, size_t basepath_length);
 
 	/** Do the scan for GRFs. */
 	static uint DoScan()
 	{
+		if (!_grf_scan_cache_loaded) LoadGRFScanCache();
+
 		GRFFileScanner fs;
-		return fs.Scan(".grf", DATA_DIR);
+		fs.Scan(".grf", DATA_DIR);
+		fs.CalcMD5Sums();
+		uint num = fs.AddResults();
+
+		/* Remember the results of this scan; NewGRFs that were not found anymore are dropped. */
+		_grf_scan_cache.swap(fs.cache);
+		SaveGRFScanCache();
+		return num;
 	}
 };
 
 bool GRFFileScanner::AddFile(const char *filename, size_t basepath_length)
 {
-	GRFConfig *c = new GRFConfig(filename + basepath_length);
+	/* Look whether the NewGRF changed since it was scanned the last time. */
+	GRFScanCache::iterator entry = this->cache.end();
+	const GRFScanCacheEntry *cached = NULL;
+	uint64 size, mtime;
+	if (GetGRFFileStamp(filename, &size, &mtime)) {
+		entry = this->cache.insert(std::make_pair(std::string(filename), GRFScanCacheEntry())).first;
+		entry->second.size = size;
+		entry->second.mtime = mtime;
+		entry->second.config = NULL;
+
+		GRFScanCache::const_iterator it = _grf_scan_cache.find(filename);
+		if (it != _grf_scan_cache.end() && it->second.size == size && it->second.mtime == mtime) cached = &it->second;
+	}
 
-	bool added = true;
-	if (FillGRFDetails(c, false)) {
-		if (_all_grfs == NULL) {
-			_all_grfs = c;
-		} else {
-			/* Insert file into list at a position determined by its
-			 * name, so the list is sorted as we go along */
-			GRFConfig **pd, *d;
-			bool stop = false;
-			for (pd = &_all_grfs; (d = *pd) != NULL; pd = &d->next) {
-				if (c->ident.grfid == d->ident.grfid && memcmp(c->ident.md5sum, d->ident.md5sum, sizeof(c->ident.md5sum)) == 0) added = false;
-				/* Because there can be multiple grfs with the same name, make sure we checked all grfs with the same name,
-				 *  before inserting the entry. So insert a new grf at the end of all grfs with the same name, instead of
-				 *  just after the first with the same name. Avoids doubles in the list. */
-				if (strcasecmp(c->GetName(), d->GetName()) <= 0) {
-					stop = true;
-				} else if (stop) {
-					break;
-				}
-			}
-			if (added) {
-				c->next = d;
-				*pd = c;
-			}
-		}
+	GRFConfig *c;
+	if (cached != NULL) {
+		/* File couldn't be opened, or is either not a NewGRF or is a 'system' NewGRF. */
+		if (cached->config == NULL) return false;
+
+		c = new GRFConfig(*cached->config);
+		free(c->filename);
+		c->filename = strdup(filename + basepath_length);
+		c->SetSuitablePalette();
 	} else {
-		added = false;
+		c = new GRFConfig(filename + basepath_length);
+		if (!ReadGRFDetails(c, false)) {
+			delete c;
+			return false;
+		}
 	}
 
-	if (!added) {
-		/* File couldn't be opened, or is either not a NewGRF or is a
-		 * 'system' NewGRF or it's already known, so forget about it. */
-		delete c;
+	GRFScanResult *result = this->results.Append();
+	result->config = c;
+	result->cache_entry = entry;
+	result->needs_md5sum = cached == NULL;
+	result->valid = true;
+	return true;
+}
+
+/** Calculate the md5sums of the NewGRFs that changed since the previous scan, in parallel. */
+void GRFFileScanner::CalcMD5Sums()
+{
+	GRFMD5SumWork work;
+	work.results = this->results.Begin();
+	work.count = this->results.Length();
+	work.next = 0;
+	work.mutex = ThreadMutex::New();
+
+	ThreadObject *threads[GRF_MD5_THREADS + 1];
+	uint num_threads = 0;
+	while (num_threads < min<uint>(GRF_MD5_THREADS, work.count) && ThreadObject::New(&CalcGRFMD5SumsThread, &work, &threads[num_threads])) {
+		num_threads++;
+	}
+
+	/* Help the threads; without threads, all work is done here. */
+	CalcGRFMD5SumsThread(&work);
+
+	for (uint i = 0; i < num_threads; i++) {
+		threads[i]->Join();
+		delete threads[i];
 	}
+	delete work.mutex;
+}
+
+/**
+ * Add the scanned NewGRFs to #_all_grfs in the order they were found, and remember them in the scan cache.
+ * @return The number of NewGRFs added to #_all_grfs.
+ */
+uint GRFFileScanner::AddResults()
+{
+	uint num = 0;
+	for (GRFScanResult *result = this->results.Begin(); result != this->results.End(); result++) {
+		GRFConfig *c = result->config;
+		result->config = NULL;
+
+		if (result->cache_entry != this->cache.end()) {
+			if (result->valid) {
+				/* The NewGRF is usable, so keep its details for the next scan. */
+				result->cache_entry->second.config = new GRFConfig(*c);
+			} else {
+				/* Reading it failed this time; do not remember it as not being a NewGRF. */
+				this->cache.erase(result->cache_entry);
+			}
+		}
 
-	return added;
+		bool added = result->valid;
+		if (added) {
+			if (_all_grfs == NULL) {
+				_all_grfs = c;
+			} else {
+				/* Insert file into list at a position determined by its
+				 * name, so the list is sorted as we go along */
+				GRFConfig **pd, *d;
+				bool stop = false;
+				for (pd = &_all_grfs; (d = *pd) != NULL; pd = &d->next) {
+					if (c->ident.grfid == d->ident.grfid && memcmp(c->ident.md5sum, d->ident.md5sum, sizeof(c->ident.md5sum)) == 0) added = false;
+					/* Because there can be multiple grfs with the same name, make sure we checked all grfs with the same name,
+					 *  before inserting the entry. So insert a new grf at the end of all grfs with the same name, instead of
+					 *  just after the first with the same name. Avoids doubles in the list. */
+					if (strcasecmp(c->GetName(), d->GetName()) <= 0) {
+						stop = true;
+					} else if (stop) {
+						break;
+					}
+				}
+				if (added) {
+					c->next = d;
+					*pd = c;
+				}
+			}
+		}
+
+		if (added) {
+			num++;
+		} else {
+			/* File couldn't be opened, or it's already known, so forget about it. */
+			delete c;
+		}
+	}
+	return num;
 }
 
 /**
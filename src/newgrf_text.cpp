@@ -27,6 +27,7 @@
 #include "debug.h"
 #include "core/alloc_type.hpp"
 #include "core/smallmap_type.hpp"
+#include "core/endian_func.hpp"
 #include "language.h"
 
 #include "table/strings.h"
@@ -838,6 +839,61 @@ void CleanUpGRFText(GRFText *grftext)
 	}
 }
 
+/**
+ * Write a GRFText list to a file, e.g. to cache the results of scanning a NewGRF.
+ * @param f    File to write to.
+ * @param list The list to write.
+ */
+void SaveGRFTextList(FILE *f, const GRFText *list)
+{
+	uint32 count = 0;
+	for (const GRFText *text = list; text != NULL; text = text->next) count++;
+
+	uint32 value = TO_LE32(count);
+	fwrite(&value, sizeof(value), 1, f);
+	for (const GRFText *text = list; text != NULL; text = text->next) {
+		value = TO_LE32((uint32)text->len);
+		fwrite(&text->langid, sizeof(text->langid), 1, f);
+		fwrite(&value, sizeof(value), 1, f);
+		fwrite(text->text, 1, text->len, f);
+	}
+}
+
+/**
+ * Read a GRFText list that was written by #SaveGRFTextList.
+ * @param f    File to read from.
+ * @param list [out] The read list; it must be freed by the caller, also when reading failed.
+ * @return Whether the list was read completely.
+ */
+bool LoadGRFTextList(FILE *f, GRFText **list)
+{
+	static const uint32 MAX_TEXT_LENGTH = 1 << 16; ///< Sanity limit on the length of a single text.
+	static const uint32 MAX_TEXT_COUNT  = 1 << 8;  ///< A list holds at most one text per language id.
+
+	*list = NULL;
+
+	uint32 count;
+	if (fread(&count, sizeof(count), 1, f) != 1) return false;
+	count = FROM_LE32(count);
+	if (count > MAX_TEXT_COUNT) return false;
+
+	SmallStackSafeStackAlloc<char, MAX_TEXT_LENGTH> text;
+	GRFText **ptext = list;
+	for (; count > 0; count--) {
+		byte langid;
+		uint32 len;
+		if (fread(&langid, sizeof(langid), 1, f) != 1 || fread(&len, sizeof(len), 1, f) != 1) return false;
+		len = FROM_LE32(len);
+		if (len > MAX_TEXT_LENGTH) return false;
+
+		if (fread(text, 1, len, f) != len) return false;
+
+		*ptext = GRFText::New(langid, text, len);
+		ptext = &(*ptext)->next;
+	}
+	return true;
+}
+
 /**
  * House cleaning.
  * Remove all strings and reset the text counter.
@@ -27,6 +27,35 @@
 #include "../../core/alloc_func.hpp"
 #include "aystar.h"
 
+/**
+ * Get memory for a node of the current search. All nodes are given back at
+ * once by #Clear, so the memory is only allocated the first time a search
+ * needs this many nodes.
+ * @return The new node; its contents are undefined.
+ */
+OpenListNode *AyStar::AllocateNode()
+{
+	if (this->free_nodes != NULL) {
+		OpenListNode *node = this->free_nodes;
+		this->free_nodes = (OpenListNode*)node->path.parent;
+		return node;
+	}
+
+	uint block = this->nodes_used / NODE_BLOCK_SIZE;
+	if (block == this->node_blocks.Length()) *this->node_blocks.Append() = MallocT<OpenListNode>(NODE_BLOCK_SIZE);
+	return &this->node_blocks[block][this->nodes_used++ % NODE_BLOCK_SIZE];
+}
+
+/**
+ * Give a node that is not referenced anymore back for reuse during the current search.
+ * @param node The node to release.
+ */
+void AyStar::ReleaseNode(OpenListNode *node)
+{
+	node->path.parent = (PathNode*)this->free_nodes;
+	this->free_nodes = node;
+}
+
 /**
  * This looks in the hash whether a node exists in the closed list.
  * @param node Node to search.
@@ -45,7 +74,7 @@ PathNode *AyStar::ClosedListIsInList(const AyStarNode *node)
 void AyStar::ClosedListAdd(const PathNode *node)
 {
 	/* Add a node to the ClosedList */
-	PathNode *new_node = MallocT<PathNode>(1);
+	PathNode *new_node = &this->AllocateNode()->path;
 	*new_node = *node;
 	this->closedlist_hash.Set(node->node.tile, node->node.direction, new_node);
 }
@@ -83,7 +112,7 @@ OpenListNode *AyStar::OpenListPop()
 void AyStar::OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g)
 {
 	/* Add a new Node to the OpenList */
-	OpenListNode *new_node = MallocT<OpenListNode>(1);
+	OpenListNode *new_node = this->AllocateNode();
 	new_node->g = g;
 	new_node->path.parent = parent;
 	new_node->path.node = *node;
@@ -172,7 +201,7 @@ int AyStar::Loop()
 		if (this->FoundEndNode != NULL) {
 			this->FoundEndNode(this, current);
 		}
-		free(current);
+		this->ReleaseNode(current);
 		return AYSTAR_FOUND_END_NODE;
 	}
 
@@ -189,7 +218,7 @@ int AyStar::Loop()
 	}
 
 	/* Free the node */
-	free(current);
+	this->ReleaseNode(current);
 
 	if (this->max_search_nodes != 0 && this->closedlist_hash.GetSize() >= this->max_search_nodes) {
 		/* We've expanded enough nodes */
@@ -206,10 +235,13 @@ int AyStar::Loop()
 void AyStar::Free()
 {
 	this->openlist_queue.Free(false);
-	/* 2nd argument above is false, below is true, to free the values only
-	 * once */
-	this->openlist_hash.Delete(true);
-	this->closedlist_hash.Delete(true);
+	/* The values are not owned by the hashes, but by the node blocks */
+	this->openlist_hash.Delete(false);
+	this->closedlist_hash.Delete(false);
+	for (OpenListNode **block = this->node_blocks.Begin(); block != this->node_blocks.End(); block++) free(*block);
+	this->node_blocks.Clear();
+	this->nodes_used = 0;
+	this->free_nodes = NULL;
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Memory free'd\n");
 #endif
@@ -221,12 +253,13 @@ void AyStar::Free()
  */
 void AyStar::Clear()
 {
-	/* Clean the Queue, but not the elements within. That will be done by
-	 * the hash. */
+	/* Clean the Queue and the hashes, but not the elements within. Those
+	 * live in the node blocks, which are kept for the next search. */
 	this->openlist_queue.Clear(false);
-	/* Clean the hashes */
-	this->openlist_hash.Clear(true);
-	this->closedlist_hash.Clear(true);
+	this->openlist_hash.Clear(false);
+	this->closedlist_hash.Clear(false);
+	this->nodes_used = 0;
+	this->free_nodes = NULL;
 
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Cleared AyStar\n");
@@ -301,4 +334,7 @@ void AyStar::Init(Hash_HashProc hash, uint num_buckets)
 	 *  When that one gets full it reserves another one, till this number
 	 *  That is why it can stay this high */
 	this->openlist_queue.Init(102400);
+
+	this->nodes_used = 0;
+	this->free_nodes = NULL;
 }
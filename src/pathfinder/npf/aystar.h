@@ -19,6 +19,7 @@
 #define AYSTAR_H
 
 #include "queue.h"
+#include "../../core/smallvec_type.hpp"
 #include "../../tile_type.h"
 #include "../../track_type.h"
 
@@ -155,11 +156,29 @@ struct AyStar {
 	void Clear();
 	void CheckTile(AyStarNode *current, OpenListNode *parent);
 
+	/**
+	 * Get the number of allocations done for nodes and hash chains since #Init.
+	 * Once the pools are warmed up, this no longer changes between searches.
+	 */
+	FORCEINLINE uint GetAllocationCount() const
+	{
+		return this->node_blocks.Length() + this->openlist_hash.allocated_nodes + this->closedlist_hash.allocated_nodes;
+	}
+
 protected:
 	Hash       closedlist_hash; ///< The actual closed list.
 	BinaryHeap openlist_queue;  ///< The open queue.
 	Hash       openlist_hash;   ///< An extra hash to speed up the process of looking up an element in the open list.
 
+	static const uint NODE_BLOCK_SIZE = 1024; ///< Number of nodes allocated at once.
+
+	SmallVector<OpenListNode *, 16> node_blocks; ///< Memory for the nodes of a search; kept allocated for the next search.
+	uint nodes_used;                             ///< Number of nodes of #node_blocks handed out during the current search.
+	OpenListNode *free_nodes;                    ///< Nodes released during the current search, linked via their parent pointer.
+
+	OpenListNode *AllocateNode();
+	void ReleaseNode(OpenListNode *node);
+
 	void OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g);
 	OpenListNode *OpenListIsInList(const AyStarNode *node);
 	OpenListNode *OpenListPop();
@@ -1009,6 +1009,7 @@ static NPFFoundTargetData NPFRouteInternal(AyStarNode *start1, bool ignore_start
 	/* GO! */
 	r = _npf_aystar.Main();
 	assert(r != AYSTAR_STILL_BUSY);
+	DEBUG(npf, 3, "Node pool: %u allocations since initialisation", _npf_aystar.GetAllocationCount());
 
 	if (result.best_bird_dist != 0) {
 		if (target != NULL) {
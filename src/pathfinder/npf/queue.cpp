@@ -30,7 +30,7 @@ const int BinaryHeap::BINARY_HEAP_BLOCKSIZE_MASK = BinaryHeap::BINARY_HEAP_BLOCK
  */
 void BinaryHeap::Clear(bool free_values)
 {
-	/* Free all items if needed and free all but the first blocks of memory */
+	/* Free all items if needed */
 	uint i;
 	uint j;
 
@@ -39,6 +39,8 @@ void BinaryHeap::Clear(bool free_values)
 			/* No more allocated blocks */
 			break;
 		}
+		/* Blocks after the one of the last element are kept, but hold no items */
+		if (i > (this->size >> BINARY_HEAP_BLOCKSIZE_BITS)) break;
 		/* For every allocated block */
 		if (free_values) {
 			for (j = 0; j < (1 << BINARY_HEAP_BLOCKSIZE_BITS); j++) {
@@ -50,14 +52,9 @@ void BinaryHeap::Clear(bool free_values)
 				free(this->elements[i][j].item);
 			}
 		}
-		if (i != 0) {
-			/* Leave the first block of memory alone */
-			free(this->elements[i]);
-			this->elements[i] = NULL;
-		}
+		/* Keep the blocks of memory, the next search will probably need them again */
 	}
 	this->size = 0;
-	this->blocks = 1;
 }
 
 /**
@@ -237,6 +234,8 @@ void Hash::Init(Hash_HashProc *hash, uint num_buckets)
 	this->hash = hash;
 	this->size = 0;
 	this->num_buckets = num_buckets;
+	this->free_nodes = NULL;
+	this->allocated_nodes = 0;
 	this->buckets = (HashNode*)MallocT<byte>(num_buckets * (sizeof(*this->buckets) + sizeof(*this->buckets_in_use)));
 	this->buckets_in_use = (bool*)(this->buckets + num_buckets);
 	for (i = 0; i < num_buckets; i++) this->buckets_in_use[i] = false;
@@ -270,6 +269,11 @@ void Hash::Delete(bool free_values)
 			}
 		}
 	}
+	while (this->free_nodes != NULL) {
+		HashNode *node = this->free_nodes;
+		this->free_nodes = node->next;
+		free(node);
+	}
 	free(this->buckets);
 	/* No need to free buckets_in_use, it is always allocated in one
 	 * malloc with buckets */
@@ -351,13 +355,39 @@ void Hash::Clear(bool free_values)
 
 				node = node->next;
 				if (free_values) free(prev->value);
-				free(prev);
+				this->ReleaseNode(prev);
 			}
 		}
 	}
 	this->size = 0;
 }
 
+/**
+ * Get a node for a bucket chain. Nodes released by earlier searches are
+ * reused, so a hash that has been used before rarely needs to allocate.
+ * @return The new node; its contents are undefined.
+ */
+HashNode *Hash::AllocateNode()
+{
+	HashNode *node = this->free_nodes;
+	if (node == NULL) {
+		this->allocated_nodes++;
+		return MallocT<HashNode>(1);
+	}
+	this->free_nodes = node->next;
+	return node;
+}
+
+/**
+ * Give a node of a bucket chain back, so it can be reused by #AllocateNode.
+ * @param node The node that is no longer part of any chain.
+ */
+void Hash::ReleaseNode(HashNode *node)
+{
+	node->next = this->free_nodes;
+	this->free_nodes = node;
+}
+
 /**
  * Finds the node that that saves this key pair. If it is not
  * found, returns NULL. If it is found, *prev is set to the
@@ -422,7 +452,7 @@ void *Hash::DeleteValue(uint key1, uint key2)
 			/* Copy the second to the first */
 			*node = *next;
 			/* Free the second */
-			free(next);
+			this->ReleaseNode(next);
 		} else {
 			/* This was the last in this bucket
 			 * Mark it as empty */
@@ -436,7 +466,7 @@ void *Hash::DeleteValue(uint key1, uint key2)
 		/* Link previous and next nodes */
 		prev->next = node->next;
 		/* Free the node */
-		free(node);
+		this->ReleaseNode(node);
 	}
 	if (result != NULL) this->size--;
 	return result;
@@ -466,7 +496,7 @@ void *Hash::Set(uint key1, uint key2, void *value)
 		node = this->buckets + hash;
 	} else {
 		/* Add it after prev */
-		node = MallocT<HashNode>(1);
+		node = this->AllocateNode();
 		prev->next = node;
 	}
 	node->next = NULL;
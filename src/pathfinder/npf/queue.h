@@ -82,6 +82,10 @@ struct Hash {
 	/* A pointer to an array of numbuckets booleans, which will be true if
 	 * there are any Nodes in the bucket */
 	bool *buckets_in_use;
+	/* Nodes that were removed from the bucket chains, kept for reuse */
+	HashNode *free_nodes;
+	/* The number of nodes that had to be allocated for the bucket chains */
+	uint allocated_nodes;
 
 	void Init(Hash_HashProc *hash, uint num_buckets);
 
@@ -106,6 +110,8 @@ protected:
 	void PrintStatistics() const;
 #endif
 	HashNode *FindNode(uint key1, uint key2, HashNode** prev_out) const;
+	HashNode *AllocateNode();
+	void ReleaseNode(HashNode *node);
 };
 
 #endif /* QUEUE_H */
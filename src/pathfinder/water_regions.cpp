@@ -0,0 +1,519 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file water_regions.cpp Coarse graph of the water network, used to guide ship pathfinding.
+ *
+ * The map is divided into square regions. Within each region the tiles ships
+ * can use are grouped into patches of tiles that are connected to each other
+ * without leaving the region. Searching over these patches is much cheaper
+ * than searching over the tiles, so it is used to find out how far away the
+ * destination is from every part of the water network; this gives the tile
+ * based pathfinder a much better estimate than the straight distance when the
+ * water route has to make a long detour.
+ *
+ * Regions are rebuilt lazily after a tile in them changed. The distances to a
+ * destination are cached until the connectivity of any region changes.
+ */
+
+#include "../stdafx.h"
+#include "../core/alloc_func.hpp"
+#include "../core/smallvec_type.hpp"
+#include "../track_func.h"
+#include "../tunnelbridge_map.h"
+#include "../tile_cmd.h"
+#include "pathfinder_type.h"
+#include "water_regions.h"
+
+#include <algorithm>
+
+/** Number of tiles in a water region. */
+static const uint WATER_REGION_NUMBER_OF_TILES = WATER_REGION_EDGE_LENGTH * WATER_REGION_EDGE_LENGTH;
+/** Maximum number of patches in a region; any further patches are merged into the last one. */
+static const uint WATER_REGION_MAX_PATCHES = 255;
+/** When this many patch identifiers have been handed out, all regions are rebuilt to start counting again. */
+static const uint32 WATER_REGION_MAX_PATCH_IDS = 1 << 24;
+/** Number of destinations for which the distances are cached. */
+static const uint WATER_REGION_DISTANCE_CACHE_SIZE = 8;
+
+/** Connected parts of the water network within one region. */
+struct WaterRegion {
+	bool built;                                    ///< Whether the region has been built at all.
+	bool dirty;                                    ///< Whether a tile of the region changed since it was built.
+	byte num_patches;                              ///< Number of patches in this region.
+	uint32 first_patch;                            ///< Identifier of the first patch; the others follow consecutively.
+	uint16 edges[DIAGDIR_END];                     ///< For each side of the region, which of the tiles along it can be left through that side.
+	byte labels[WATER_REGION_NUMBER_OF_TILES];     ///< Patch of each tile, counted from 1; 0 when ships cannot use the tile.
+	SmallVector<TileIndex, 4> centres;             ///< Tile at the centre of each patch.
+	SmallVector<TileIndex, 4> aqueducts;           ///< Aqueduct heads within the region.
+
+	WaterRegion() : built(false), dirty(false), num_patches(0), first_patch(0)
+	{
+		memset(this->edges, 0, sizeof(this->edges));
+		memset(this->labels, 0, sizeof(this->labels));
+	}
+
+	/**
+	 * Check whether two builds of a region describe the same connectivity.
+	 * @param other The other build.
+	 * @return True when nothing relevant for the distances differs.
+	 */
+	bool SameConnectivity(const WaterRegion &other) const
+	{
+		if (this->num_patches != other.num_patches) return false;
+		if (memcmp(this->edges, other.edges, sizeof(this->edges)) != 0) return false;
+		if (memcmp(this->labels, other.labels, sizeof(this->labels)) != 0) return false;
+		if (this->aqueducts.Length() != other.aqueducts.Length()) return false;
+		for (uint i = 0; i < this->aqueducts.Length(); i++) {
+			if (this->aqueducts[i] != other.aqueducts[i]) return false;
+		}
+		return true;
+	}
+};
+
+/** Estimated distances from every patch to one destination. */
+struct WaterRegionDistances {
+	TileIndex dest;              ///< The destination tile.
+	uint32 version;              ///< Value of #_water_region_version when the distances were calculated.
+	uint32 last_used;            ///< Moment of the last use, to find the least recently used entry.
+	SmallVector<uint, 256> dist; ///< Distance of each patch, indexed by patch identifier.
+
+	/**
+	 * Get the distance of a patch.
+	 * @param id Identifier of the patch.
+	 * @return The distance, or #WATER_REGION_UNREACHABLE.
+	 */
+	FORCEINLINE uint Get(uint32 id) const
+	{
+		return id < this->dist.Length() ? this->dist[id] : WATER_REGION_UNREACHABLE;
+	}
+
+	/**
+	 * Set the distance of a patch.
+	 * @param id Identifier of the patch.
+	 * @param d The new distance.
+	 */
+	void Set(uint32 id, uint d)
+	{
+		while (this->dist.Length() <= id) *this->dist.Append() = WATER_REGION_UNREACHABLE;
+		this->dist[id] = d;
+	}
+};
+
+/** Entry of the queue of the search over the patches. */
+struct WaterPatchQueueItem {
+	uint dist;     ///< Distance of the patch.
+	uint region;   ///< Index of the region of the patch.
+	byte label;    ///< Label of the patch within its region.
+
+	/** Order the queue so the closest patch comes first. */
+	bool operator <(const WaterPatchQueueItem &other) const
+	{
+		return this->dist > other.dist;
+	}
+};
+
+static WaterRegion *_water_regions = NULL;         ///< All regions of the map, or \c NULL when not needed yet.
+static uint _water_regions_x;                      ///< Number of regions along the x axis.
+static uint _water_regions_y;                      ///< Number of regions along the y axis.
+static uint32 _water_patch_count;                  ///< Number of patch identifiers handed out.
+static uint32 _water_region_version;               ///< Changed whenever the connectivity of a region changes.
+static uint32 _water_region_uses;                  ///< Counter for the least recently used distance cache entry.
+static SmallVector<uint, 32> _water_regions_dirty; ///< Regions marked dirty since the last search.
+static WaterRegionDistances _water_region_distances[WATER_REGION_DISTANCE_CACHE_SIZE]; ///< Cache of distances per destination.
+
+/**
+ * Get the index of the region a tile is in.
+ * @param tile The tile.
+ * @return The index of the region.
+ */
+static FORCEINLINE uint GetWaterRegionIndex(TileIndex tile)
+{
+	return (TileY(tile) / WATER_REGION_EDGE_LENGTH) * _water_regions_x + TileX(tile) / WATER_REGION_EDGE_LENGTH;
+}
+
+/** Forget all regions; they are set up again once they are needed. */
+void InitializeWaterRegions()
+{
+	delete[] _water_regions;
+	_water_regions = NULL;
+	_water_regions_dirty.Clear();
+	_water_patch_count = 0;
+	_water_region_version++;
+}
+
+/**
+ * Note that a tile changed in a way that might affect ships.
+ * @param tile The changed tile.
+ */
+void InvalidateWaterRegion(TileIndex tile)
+{
+	if (_water_regions == NULL || tile >= MapSize()) return;
+
+	uint index = GetWaterRegionIndex(tile);
+	WaterRegion &region = _water_regions[index];
+	if (!region.built || region.dirty) return;
+
+	region.dirty = true;
+	*_water_regions_dirty.Append() = index;
+}
+
+/**
+ * Get the tracks ships can use on a tile.
+ * @param tile The tile.
+ * @return The tracks.
+ */
+static TrackBits GetWaterTracks(TileIndex tile)
+{
+	return TrackStatusToTrackBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0));
+}
+
+/**
+ * Check whether a ship can leave a tile through the given side.
+ * @param tracks The tracks of the tile.
+ * @param side The side of the tile.
+ * @return True when a track touches that side.
+ */
+static FORCEINLINE bool TracksReachSide(TrackBits tracks, DiagDirection side)
+{
+	return (tracks & DiagdirReachesTracks(ReverseDiagDir(side))) != TRACK_BIT_NONE;
+}
+
+/**
+ * Find the tile a ship arrives at when leaving a tile through the given side.
+ * @param tile The tile to leave.
+ * @param side The side to leave it through.
+ * @return The next tile, or #INVALID_TILE at the border of the map.
+ */
+static TileIndex GetWaterNeighbour(TileIndex tile, DiagDirection side)
+{
+	if (IsTileType(tile, MP_TUNNELBRIDGE) && GetTunnelBridgeTransportType(tile) == TRANSPORT_WATER && GetTunnelBridgeDirection(tile) == side) {
+		return GetOtherTunnelBridgeEnd(tile);
+	}
+	return AddTileIndexDiffCWrap(tile, TileIndexDiffCByDiagDir(side));
+}
+
+/**
+ * Get the position of a tile within its region.
+ * @param tile The tile.
+ * @return Index into WaterRegion::labels.
+ */
+static FORCEINLINE uint GetLocalIndex(TileIndex tile)
+{
+	return (TileY(tile) % WATER_REGION_EDGE_LENGTH) * WATER_REGION_EDGE_LENGTH + TileX(tile) % WATER_REGION_EDGE_LENGTH;
+}
+
+/**
+ * Get the position of a tile along the side of its region it is on.
+ * @param local Position of the tile within its region.
+ * @param side The side of the region.
+ * @return Bit number in WaterRegion::edges.
+ */
+static FORCEINLINE uint GetEdgeIndex(uint local, DiagDirection side)
+{
+	return DiagDirToAxis(side) == AXIS_X ? local / WATER_REGION_EDGE_LENGTH : local % WATER_REGION_EDGE_LENGTH;
+}
+
+/**
+ * Check whether a tile is on the given side of its region.
+ * @param local Position of the tile within its region.
+ * @param side The side of the region.
+ * @return True when the tile is at that side.
+ */
+static FORCEINLINE bool IsAtRegionSide(uint local, DiagDirection side)
+{
+	switch (side) {
+		default: NOT_REACHED();
+		case DIAGDIR_NE: return local % WATER_REGION_EDGE_LENGTH == 0;
+		case DIAGDIR_SE: return local / WATER_REGION_EDGE_LENGTH == WATER_REGION_EDGE_LENGTH - 1;
+		case DIAGDIR_SW: return local % WATER_REGION_EDGE_LENGTH == WATER_REGION_EDGE_LENGTH - 1;
+		case DIAGDIR_NW: return local / WATER_REGION_EDGE_LENGTH == 0;
+	}
+}
+
+/**
+ * Determine the patches of a region from the current map.
+ * @param index Index of the region.
+ * @param region Where to store the result; must be a freshly constructed region.
+ */
+static void FillWaterRegion(uint index, WaterRegion &region)
+{
+	TileIndex top = TileXY((index % _water_regions_x) * WATER_REGION_EDGE_LENGTH, (index / _water_regions_x) * WATER_REGION_EDGE_LENGTH);
+
+	TrackBits tracks[WATER_REGION_NUMBER_OF_TILES];
+	for (uint i = 0; i < WATER_REGION_NUMBER_OF_TILES; i++) {
+		TileIndex tile = top + TileDiffXY(i % WATER_REGION_EDGE_LENGTH, i / WATER_REGION_EDGE_LENGTH);
+		tracks[i] = GetWaterTracks(tile);
+		if (tracks[i] == TRACK_BIT_NONE) continue;
+
+		if (IsTileType(tile, MP_TUNNELBRIDGE) && GetTunnelBridgeTransportType(tile) == TRANSPORT_WATER) *region.aqueducts.Append() = tile;
+		for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+			if (IsAtRegionSide(i, side) && TracksReachSide(tracks[i], side)) SetBit(region.edges[side], GetEdgeIndex(i, side));
+		}
+	}
+
+	/* Flood fill the patches, only following connections within the region. */
+	uint stack[WATER_REGION_NUMBER_OF_TILES];
+	for (uint start = 0; start < WATER_REGION_NUMBER_OF_TILES; start++) {
+		if (tracks[start] == TRACK_BIT_NONE || region.labels[start] != 0) continue;
+
+		if (region.num_patches < WATER_REGION_MAX_PATCHES) {
+			region.num_patches++;
+			*region.centres.Append() = INVALID_TILE;
+		}
+		byte label = region.num_patches;
+		uint sum_x = 0, sum_y = 0, count = 0;
+
+		uint depth = 0;
+		stack[depth++] = start;
+		region.labels[start] = label;
+		while (depth > 0) {
+			uint local = stack[--depth];
+			sum_x += local % WATER_REGION_EDGE_LENGTH;
+			sum_y += local / WATER_REGION_EDGE_LENGTH;
+			count++;
+
+			for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+				if (IsAtRegionSide(local, side) || !TracksReachSide(tracks[local], side)) continue;
+
+				TileIndexDiffC diff = TileIndexDiffCByDiagDir(side);
+				uint next = local + diff.y * (int)WATER_REGION_EDGE_LENGTH + diff.x;
+				if (region.labels[next] != 0 || !TracksReachSide(tracks[next], ReverseDiagDir(side))) continue;
+
+				region.labels[next] = label;
+				stack[depth++] = next;
+			}
+		}
+
+		/* Merged patches keep the centre of the first one. */
+		if (region.centres[label - 1] == INVALID_TILE) {
+			region.centres[label - 1] = top + TileDiffXY(sum_x / count, sum_y / count);
+		}
+	}
+	region.built = true;
+}
+
+/**
+ * Bring a dirty region up to date.
+ * @param index Index of the region.
+ */
+static void RebuildWaterRegion(uint index)
+{
+	WaterRegion &region = _water_regions[index];
+	WaterRegion *rebuilt = new WaterRegion();
+	FillWaterRegion(index, *rebuilt);
+
+	if (!region.built || !region.SameConnectivity(*rebuilt)) {
+		rebuilt->first_patch = _water_patch_count;
+		_water_patch_count += rebuilt->num_patches;
+		/* Distances calculated before cannot know about patches of regions that did not exist yet,
+		 * so they consider them unreachable, which is still right. Only a changed region makes them stale. */
+		if (region.built) _water_region_version++;
+	} else {
+		rebuilt->first_patch = region.first_patch;
+	}
+
+	region.num_patches = rebuilt->num_patches;
+	region.first_patch = rebuilt->first_patch;
+	memcpy(region.edges, rebuilt->edges, sizeof(region.edges));
+	memcpy(region.labels, rebuilt->labels, sizeof(region.labels));
+	region.centres.Clear();
+	for (uint i = 0; i < rebuilt->centres.Length(); i++) *region.centres.Append() = rebuilt->centres[i];
+	region.aqueducts.Clear();
+	for (uint i = 0; i < rebuilt->aqueducts.Length(); i++) *region.aqueducts.Append() = rebuilt->aqueducts[i];
+	region.built = true;
+	region.dirty = false;
+
+	delete rebuilt;
+}
+
+/**
+ * Get a region, building it when needed.
+ * @param index Index of the region.
+ * @return The region.
+ */
+static WaterRegion &GetWaterRegion(uint index)
+{
+	WaterRegion &region = _water_regions[index];
+	if (!region.built || region.dirty) RebuildWaterRegion(index);
+	return region;
+}
+
+/** Make sure the regions exist and none of them is dirty. */
+static void UpdateWaterRegions()
+{
+	if (_water_regions == NULL) {
+		_water_regions_x = MapSizeX() / WATER_REGION_EDGE_LENGTH;
+		_water_regions_y = MapSizeY() / WATER_REGION_EDGE_LENGTH;
+		_water_regions = new WaterRegion[_water_regions_x * _water_regions_y];
+		_water_patch_count = 0;
+		_water_region_version++;
+	}
+
+	for (uint i = 0; i < _water_regions_dirty.Length(); i++) {
+		RebuildWaterRegion(_water_regions_dirty[i]);
+	}
+	_water_regions_dirty.Clear();
+
+	if (_water_patch_count >= WATER_REGION_MAX_PATCH_IDS) {
+		/* Start counting again; everything is built again when needed. */
+		InitializeWaterRegions();
+		UpdateWaterRegions();
+	}
+}
+
+/**
+ * Estimate the cost of travelling between two tiles in the same way YAPF estimates it.
+ * @param a The first tile.
+ * @param b The second tile.
+ * @return The estimated cost.
+ */
+static uint GetWaterRegionTileDistance(TileIndex a, TileIndex b)
+{
+	uint dx = Delta(TileX(a), TileX(b));
+	uint dy = Delta(TileY(a), TileY(b));
+	return min(dx, dy) * 2 * YAPF_TILE_CORNER_LENGTH + Delta(dx, dy) * YAPF_TILE_LENGTH;
+}
+
+/**
+ * Add a patch to the search queue when the new distance is shorter.
+ * @param distances The distances found so far.
+ * @param queue The search queue.
+ * @param index Index of the region of the patch.
+ * @param label Label of the patch.
+ * @param dist The new distance.
+ */
+static void RelaxWaterPatch(WaterRegionDistances &distances, SmallVector<WaterPatchQueueItem, 256> &queue, uint index, byte label, uint dist)
+{
+	const WaterRegion &region = GetWaterRegion(index);
+	uint32 id = region.first_patch + label - 1;
+	if (distances.Get(id) <= dist) return;
+
+	distances.Set(id, dist);
+	WaterPatchQueueItem *item = queue.Append();
+	item->dist = dist;
+	item->region = index;
+	item->label = label;
+	std::push_heap(queue.Begin(), queue.End());
+}
+
+/**
+ * Search from the destination over the patches of all regions.
+ * @param distances Where to store the distances; its destination must be set.
+ */
+static void CalculateWaterRegionDistances(WaterRegionDistances &distances)
+{
+	distances.dist.Clear();
+	SmallVector<WaterPatchQueueItem, 256> queue;
+
+	/* The destination itself might not be water (e.g. a dock), so also start from the water next to it. */
+	for (int i = -1; i < DIAGDIR_END; i++) {
+		TileIndex tile = (i < 0) ? distances.dest : AddTileIndexDiffCWrap(distances.dest, TileIndexDiffCByDiagDir((DiagDirection)i));
+		if (tile == INVALID_TILE) continue;
+
+		uint index = GetWaterRegionIndex(tile);
+		const WaterRegion &region = GetWaterRegion(index);
+		byte label = region.labels[GetLocalIndex(tile)];
+		if (label == 0) continue;
+
+		RelaxWaterPatch(distances, queue, index, label, GetWaterRegionTileDistance(region.centres[label - 1], distances.dest));
+	}
+
+	while (queue.Length() > 0) {
+		std::pop_heap(queue.Begin(), queue.End());
+		WaterPatchQueueItem current = *(queue.End() - 1);
+		queue.Erase(queue.End() - 1);
+
+		const WaterRegion &region = GetWaterRegion(current.region);
+		if (distances.Get(region.first_patch + current.label - 1) < current.dist) continue;
+		TileIndex centre = region.centres[current.label - 1];
+
+		/* Neighbouring regions. */
+		uint rx = current.region % _water_regions_x;
+		uint ry = current.region / _water_regions_x;
+		for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+			if (region.edges[side] == 0) continue;
+
+			TileIndexDiffC diff = TileIndexDiffCByDiagDir(side);
+			if ((uint)(rx + diff.x) >= _water_regions_x || (uint)(ry + diff.y) >= _water_regions_y) continue;
+			uint neighbour_index = current.region + diff.y * (int)_water_regions_x + diff.x;
+			const WaterRegion &neighbour = GetWaterRegion(neighbour_index);
+			uint16 crossings = region.edges[side] & neighbour.edges[ReverseDiagDir(side)];
+
+			uint bit;
+			FOR_EACH_SET_BIT(bit, crossings) {
+				uint local = (DiagDirToAxis(side) == AXIS_X) ? bit * WATER_REGION_EDGE_LENGTH : bit;
+				if (side == DIAGDIR_SW) local += WATER_REGION_EDGE_LENGTH - 1;
+				if (side == DIAGDIR_SE) local += (WATER_REGION_EDGE_LENGTH - 1) * WATER_REGION_EDGE_LENGTH;
+				if (region.labels[local] != current.label) continue;
+
+				/* The tile at the same position on the opposite side of the neighbour. */
+				uint neighbour_local = local - diff.y * (int)((WATER_REGION_EDGE_LENGTH - 1) * WATER_REGION_EDGE_LENGTH) - diff.x * (int)(WATER_REGION_EDGE_LENGTH - 1);
+				byte label = neighbour.labels[neighbour_local];
+				RelaxWaterPatch(distances, queue, neighbour_index, label, current.dist + GetWaterRegionTileDistance(centre, neighbour.centres[label - 1]));
+			}
+		}
+
+		/* Aqueducts lead to other regions directly. */
+		for (uint i = 0; i < region.aqueducts.Length(); i++) {
+			TileIndex head = region.aqueducts[i];
+			if (region.labels[GetLocalIndex(head)] != current.label) continue;
+
+			TileIndex other = GetWaterNeighbour(head, GetTunnelBridgeDirection(head));
+			uint other_index = GetWaterRegionIndex(other);
+			const WaterRegion &other_region = GetWaterRegion(other_index);
+			byte label = other_region.labels[GetLocalIndex(other)];
+			if (label == 0) continue;
+
+			RelaxWaterPatch(distances, queue, other_index, label, current.dist + GetWaterRegionTileDistance(centre, other_region.centres[label - 1]));
+		}
+	}
+}
+
+/**
+ * Get the estimated distances from all of the water network to a destination.
+ * The result stays valid until the map changes.
+ * @param dest The destination tile.
+ * @return The distances; use #GetWaterRegionDistance to query them.
+ */
+const WaterRegionDistances *GetWaterRegionDistances(TileIndex dest)
+{
+	UpdateWaterRegions();
+	_water_region_uses++;
+
+	WaterRegionDistances *oldest = &_water_region_distances[0];
+	for (uint i = 0; i < WATER_REGION_DISTANCE_CACHE_SIZE; i++) {
+		WaterRegionDistances *d = &_water_region_distances[i];
+		if (d->dest == dest && d->version == _water_region_version && d->dist.Length() > 0) {
+			d->last_used = _water_region_uses;
+			return d;
+		}
+		if (d->last_used < oldest->last_used) oldest = d;
+	}
+
+	oldest->dest = dest;
+	oldest->last_used = _water_region_uses;
+	oldest->version = _water_region_version;
+	CalculateWaterRegionDistances(*oldest);
+	return oldest;
+}
+
+/**
+ * Get the estimated distance from a tile to the destination of the given distances.
+ * @param distances Result of #GetWaterRegionDistances.
+ * @param tile The tile to get the distance of.
+ * @return The estimated distance in YAPF cost units, or #WATER_REGION_UNREACHABLE.
+ */
+uint GetWaterRegionDistance(const WaterRegionDistances *distances, TileIndex tile)
+{
+	const WaterRegion &region = GetWaterRegion(GetWaterRegionIndex(tile));
+	byte label = region.labels[GetLocalIndex(tile)];
+	if (label == 0) return WATER_REGION_UNREACHABLE;
+	return distances->Get(region.first_patch + label - 1);
+}
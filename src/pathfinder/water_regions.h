@@ -0,0 +1,45 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.h Coarse graph of the water network, used to guide ship pathfinding. */
+
+#ifndef WATER_REGIONS_H
+#define WATER_REGIONS_H
+
+#include "../tile_type.h"
+
+/** Number of tiles along each side of a water region. */
+static const uint WATER_REGION_EDGE_LENGTH = 16;
+
+/** Estimated distance returned for tiles from which the destination cannot be reached. */
+static const uint WATER_REGION_UNREACHABLE = UINT_MAX;
+
+/**
+ * Estimated distances from every part of the water network to one destination,
+ * obtained from a search over the water regions instead of over the tiles.
+ */
+struct WaterRegionDistances;
+
+/**
+ * Check whether tiles of a type can be used by ships.
+ * @param type The tile type.
+ * @return True when changing such a tile might change the water regions.
+ */
+static inline bool IsWaterRegionTileType(TileType type)
+{
+	return type == MP_WATER || type == MP_STATION || type == MP_TUNNELBRIDGE;
+}
+
+void InitializeWaterRegions();
+void InvalidateWaterRegion(TileIndex tile);
+
+const WaterRegionDistances *GetWaterRegionDistances(TileIndex dest);
+uint GetWaterRegionDistance(const WaterRegionDistances *distances, TileIndex tile);
+
+#endif /* WATER_REGIONS_H */
@@ -16,6 +16,9 @@
 #include "../../misc/hashtable.hpp"
 #include "../../misc/binaryheap.hpp"
 
+extern uint _yapf_nodelist_searches;
+extern uint _yapf_nodelist_allocations;
+
 /**
  * Hash table based node list multi-container class.
  *  Implements open list, closed list and priority queue for A-star
@@ -38,27 +41,90 @@ public:
 	typedef CBinaryHeapT<Titem_> CPriorityQueue;
 
 protected:
+	/**
+	 * Containers of one search. Allocating them is more expensive than most
+	 *  searches, so they are kept in a pool and reused by following searches.
+	 */
+	struct Storage {
+		CItemArray            m_arr;        ///< here we store full item data (Titem_)
+		COpenList             m_open;       ///< hash table of pointers to open item data
+		CClosedList           m_closed;     ///< hash table of pointers to closed item data
+		CPriorityQueue        m_open_queue; ///< priority queue of pointers to open item data
+		Storage              *m_next_free;  ///< next unused storage in the pool
+
+		Storage() : m_open_queue(2048), m_next_free(NULL) {}
+
+		/** forget all nodes of the previous search, but keep the allocated memory */
+		FORCEINLINE void Reset()
+		{
+			/* the items are still valid, so they tell which hash slots were used */
+			m_open.ClearItems(m_arr);
+			m_closed.ClearItems(m_arr);
+			m_open_queue.Clear();
+			m_arr.Reset();
+		}
+	};
+
+	/** pool of unused storages; they are freed when the game exits */
+	struct StoragePool {
+		Storage *m_first; ///< first unused storage
+
+		~StoragePool()
+		{
+			while (m_first != NULL) {
+				Storage *s = m_first;
+				m_first = s->m_next_free;
+				delete s;
+			}
+		}
+	};
+	static StoragePool s_pool;
+
+	/** storage taken from the pool for the lifetime of this node list */
+	Storage              *m_storage;
 	/** here we store full item data (Titem_) */
-	CItemArray            m_arr;
+	CItemArray&           m_arr;
 	/** hash table of pointers to open item data */
-	COpenList             m_open;
+	COpenList&            m_open;
 	/** hash table of pointers to closed item data */
-	CClosedList           m_closed;
+	CClosedList&          m_closed;
 	/** priority queue of pointers to open item data */
-	CPriorityQueue        m_open_queue;
+	CPriorityQueue&       m_open_queue;
 	/** new open node under construction */
 	Titem                *m_new_node;
+
+	/** take an unused storage from the pool, or allocate a new one when the pool is empty */
+	static Storage *AcquireStorage()
+	{
+		_yapf_nodelist_searches++;
+		Storage *s = s_pool.m_first;
+		if (s == NULL) {
+			_yapf_nodelist_allocations++;
+			return new Storage();
+		}
+		s_pool.m_first = s->m_next_free;
+		s->m_next_free = NULL;
+		return s;
+	}
+
 public:
 	/** default constructor */
 	CNodeList_HashTableT()
-		: m_open_queue(2048)
+		: m_storage(AcquireStorage())
+		, m_arr(m_storage->m_arr)
+		, m_open(m_storage->m_open)
+		, m_closed(m_storage->m_closed)
+		, m_open_queue(m_storage->m_open_queue)
 	{
 		m_new_node = NULL;
 	}
 
-	/** destructor */
+	/** destructor - returns the storage to the pool */
 	~CNodeList_HashTableT()
 	{
+		m_storage->Reset();
+		m_storage->m_next_free = s_pool.m_first;
+		s_pool.m_first = m_storage;
 	}
 
 	/** return number of open nodes */
@@ -163,4 +229,7 @@ public:
 	}
 };
 
+template <class Titem_, int Thash_bits_open_, int Thash_bits_closed_>
+typename CNodeList_HashTableT<Titem_, Thash_bits_open_, Thash_bits_closed_>::StoragePool CNodeList_HashTableT<Titem_, Thash_bits_open_, Thash_bits_closed_>::s_pool;
+
 #endif /* NODELIST_HPP */
@@ -196,6 +196,9 @@ protected:
 			last_date = _date;
 			DEBUG(yapf, 2, "Pf time today: %5d ms", _total_pf_time_us / 1000);
 			_total_pf_time_us = 0;
+			DEBUG(yapf, 2, "Node lists today: %d searches, %d storage allocations", _yapf_nodelist_searches, _yapf_nodelist_allocations);
+			_yapf_nodelist_searches = 0;
+			_yapf_nodelist_allocations = 0;
 		}
 
 		/* delete the cache sometimes... */
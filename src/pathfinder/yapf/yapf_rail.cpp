@@ -36,6 +36,8 @@ template <typename Tpf> void DumpState(Tpf &pf1, Tpf &pf2)
 #endif
 
 int _total_pf_time_us = 0;
+uint _yapf_nodelist_searches = 0;    ///< Number of node lists used by YAPF searches.
+uint _yapf_nodelist_allocations = 0; ///< Number of node list storages that had to be allocated for them.
 
 template <class Types>
 class CYapfReserveTrack
@@ -14,6 +14,13 @@
 
 #include "yapf.hpp"
 #include "yapf_node_ship.hpp"
+#include "../water_regions.h"
+
+/**
+ * How much the estimate from the water regions is lowered. It is the distance from
+ *  the centre of a region, so a tile can be up to the width of a region closer.
+ */
+static const uint YAPF_WATER_REGION_SLACK = (WATER_REGION_EDGE_LENGTH - 1) * 2 * YAPF_TILE_CORNER_LENGTH;
 
 /** Node Follower module of YAPF for ships */
 template <class Types>
@@ -100,6 +107,52 @@ public:
 	}
 };
 
+/**
+ * Destination module of YAPF for ships. When the water route has to make a
+ *  detour, the straight distance is a poor estimate; the distance through the
+ *  water regions is used then. That estimate can be slightly too high, which
+ *  makes the search much faster at the price of sometimes not finding the
+ *  shortest route.
+ */
+template <class Types>
+class CYapfDestinationTileWaterT : public CYapfDestinationTileT<Types>
+{
+public:
+	typedef CYapfDestinationTileT<Types> Tbase;    ///< the destination module we extend
+	typedef typename Types::NodeList::Titem Node; ///< this will be our node type
+
+protected:
+	const WaterRegionDistances *m_region_distances; ///< distances to the destination through the water regions
+
+public:
+	/** set the destination tile / more trackdirs */
+	void SetDestination(TileIndex tile, TrackdirBits trackdirs)
+	{
+		Tbase::SetDestination(tile, trackdirs);
+		m_region_distances = GetWaterRegionDistances(tile);
+	}
+
+	/**
+	 * Called by YAPF to calculate cost estimate. Uses the larger of the straight
+	 *  distance and the distance through the water regions.
+	 */
+	inline bool PfCalcEstimate(Node& n)
+	{
+		if (Tbase::PfDetectDestination(n)) {
+			n.m_estimate = n.m_cost;
+			return true;
+		}
+
+		int d = Tbase::DistanceEstimate(n);
+		uint region_distance = GetWaterRegionDistance(m_region_distances, n.GetTile());
+		if (region_distance != WATER_REGION_UNREACHABLE && region_distance > YAPF_WATER_REGION_SLACK) {
+			d = max(d, (int)(region_distance - YAPF_WATER_REGION_SLACK));
+		}
+		n.m_estimate = n.m_cost + d;
+		return true;
+	}
+};
+
 /** Cost Provider module of YAPF for ships */
 template <class Types>
 class CYapfCostShipT
@@ -162,7 +215,7 @@ struct CYapfShip_TypesT
 	typedef CYapfBaseT<Types>                 PfBase;        // base pathfinder class
 	typedef CYapfFollowShipT<Types>           PfFollow;      // node follower
 	typedef CYapfOriginTileT<Types>           PfOrigin;      // origin provider
-	typedef CYapfDestinationTileT<Types>      PfDestination; // destination/distance provider
+	typedef CYapfDestinationTileWaterT<Types> PfDestination; // destination/distance provider
 	typedef CYapfSegmentCostCacheNoneT<Types> PfCache;       // segment cost cache provider
 	typedef CYapfCostShipT<Types>             PfCost;        // cost provider
 };
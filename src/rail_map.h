@@ -84,6 +84,7 @@ static inline bool HasSignals(TileIndex t)
 static inline void SetHasSignals(TileIndex tile, bool signals)
 {
 	assert(IsPlainRailTile(tile));
+	InvalidateSignalSegments();
 	SB(_m[tile].m5, 6, 1, signals);
 }
 
@@ -148,6 +149,7 @@ static inline TrackBits GetTrackBits(TileIndex tile)
 static inline void SetTrackBits(TileIndex t, TrackBits b)
 {
 	assert(IsPlainRailTile(t));
+	InvalidateSignalSegments();
 	SB(_m[t].m5, 0, 6, b);
 }
 
@@ -302,6 +304,7 @@ static inline void SetSignalType(TileIndex t, Track track, SignalType s)
 {
 	assert(GetRailTileType(t) == RAIL_TILE_SIGNALS);
 	byte pos = (track == TRACK_LOWER || track == TRACK_RIGHT) ? 4 : 0;
+	InvalidateSignalSegments();
 	SB(_m[t].m2, pos, 3, s);
 	if (track == INVALID_TRACK) SB(_m[t].m2, 4, 3, s);
 }
@@ -329,6 +332,7 @@ static inline void CycleSignalSide(TileIndex t, Track track)
 
 	sig = GB(_m[t].m3, pos, 2);
 	if (--sig == 0) sig = IsPbsSignal(GetSignalType(t, track)) ? 2 : 3;
+	InvalidateSignalSegments();
 	SB(_m[t].m3, pos, 2, sig);
 }
 
@@ -393,6 +397,7 @@ static inline SignalState GetSingleSignalState(TileIndex t, byte signalbit)
  */
 static inline void SetPresentSignals(TileIndex tile, uint signals)
 {
+	InvalidateSignalSegments();
 	SB(_m[tile].m3, 4, 4, signals);
 }
 
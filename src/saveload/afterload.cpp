@@ -27,6 +27,7 @@
 #include "../roadveh.h"
 #include "../train.h"
 #include "../station_base.h"
+#include "../station_func.h"
 #include "../waypoint_base.h"
 #include "../roadstop_base.h"
 #include "../tunnelbridge_map.h"
@@ -52,6 +53,7 @@
 #include "../core/backup_type.hpp"
 #include "../smallmap_gui.h"
 #include "../news_func.h"
+#include "../thread/thread.h"
 
 #include "table/strings.h"
 
@@ -474,6 +476,284 @@ static uint FixVehicleInclination(Vehicle *v, Direction dir)
 	return 1U << GVF_GOINGUP_BIT;
 }
 
+/** Flags of a tile fix-up pass. */
+enum AfterLoadTilePassFlags {
+	ALTPF_NONE       = 0,      ///< The pass may look at other tiles or pools, so it gets a sweep over the map of its own.
+	ALTPF_TILE_LOCAL = 1 << 0, ///< The pass only changes the given tile and reads nothing but that tile and tile heights.
+};
+
+/** A fix-up that has to be done on every tile of savegames in a range of versions. */
+struct AfterLoadTilePass {
+	uint16 from_version; ///< First savegame version that needs the pass.
+	uint16 to_version;   ///< First savegame version that does not need the pass anymore.
+	byte flags;          ///< Flags of the pass, see #AfterLoadTilePassFlags.
+	void (*proc)(TileIndex t); ///< Fix-up of a single tile.
+};
+
+/** Number of bands the map is split into for running tile local passes in parallel. */
+static const uint AFTERLOAD_TILE_BANDS = 4;
+/** Smallest map that is worth starting threads for. */
+static const uint AFTERLOAD_PARALLEL_MIN_TILES = 512 * 512;
+
+/** Passes to run over a band of the map. */
+struct AfterLoadTileBand {
+	const AfterLoadTilePass * const *passes; ///< The passes, in order.
+	uint count;      ///< Number of passes.
+	TileIndex begin; ///< First tile of the band.
+	TileIndex end;   ///< One past the last tile of the band.
+};
+
+/**
+ * Run passes over all tiles of a band of the map, all passes on a tile before going to the next tile.
+ * @param param The #AfterLoadTileBand to run.
+ */
+static void RunAfterLoadTileBand(void *param)
+{
+	const AfterLoadTileBand *band = (const AfterLoadTileBand *)param;
+
+	for (TileIndex t = band->begin; t != band->end; t++) {
+		for (uint i = 0; i < band->count; i++) band->passes[i]->proc(t);
+	}
+}
+
+/**
+ * Run passes in a single sweep over the map.
+ * @param passes   The passes, in order.
+ * @param count    Number of passes.
+ * @param parallel Whether the passes are all tile local, so the map can be split over threads.
+ */
+static void RunAfterLoadTileSweep(const AfterLoadTilePass * const *passes, uint count, bool parallel)
+{
+	uint num_bands = (parallel && MapSize() >= AFTERLOAD_PARALLEL_MIN_TILES) ? AFTERLOAD_TILE_BANDS : 1;
+	uint band_size = MapSize() / num_bands;
+
+	AfterLoadTileBand bands[AFTERLOAD_TILE_BANDS];
+	ThreadObject *threads[AFTERLOAD_TILE_BANDS];
+	for (uint i = 0; i < num_bands; i++) {
+		bands[i].passes = passes;
+		bands[i].count = count;
+		bands[i].begin = i * band_size;
+		bands[i].end = (i + 1 == num_bands) ? MapSize() : (i + 1) * band_size;
+	}
+
+	/* We do the first band ourselves; when a thread can not be made, its band too. */
+	for (uint i = 1; i < num_bands; i++) {
+		if (!ThreadObject::New(&RunAfterLoadTileBand, &bands[i], &threads[i])) {
+			threads[i] = NULL;
+			RunAfterLoadTileBand(&bands[i]);
+		}
+	}
+	RunAfterLoadTileBand(&bands[0]);
+
+	for (uint i = 1; i < num_bands; i++) {
+		if (threads[i] == NULL) continue;
+		threads[i]->Join();
+		delete threads[i];
+	}
+}
+
+/**
+ * Run the tile fix-up passes that are needed for the loaded savegame.
+ * Passes are run in the given order; subsequent tile local passes share
+ * a sweep over the map, and such a sweep is split over several threads.
+ * @param passes The passes; later passes depend on all earlier ones.
+ * @param count  Number of passes.
+ */
+static void RunAfterLoadTilePasses(const AfterLoadTilePass *passes, uint count)
+{
+	const AfterLoadTilePass **sweep = AllocaM(const AfterLoadTilePass *, count);
+	uint num_sweep = 0;
+	bool local = true;
+
+	for (uint i = 0; i < count; i++) {
+		const AfterLoadTilePass *pass = &passes[i];
+		if (IsSavegameVersionBefore(pass->from_version) || !IsSavegameVersionBefore(pass->to_version)) continue;
+
+		bool pass_local = (pass->flags & ALTPF_TILE_LOCAL) != 0;
+		if (num_sweep != 0 && (!local || !pass_local)) {
+			RunAfterLoadTileSweep(sweep, num_sweep, local);
+			num_sweep = 0;
+			local = true;
+		}
+
+		sweep[num_sweep++] = pass;
+		local &= pass_local;
+	}
+
+	if (num_sweep != 0) RunAfterLoadTileSweep(sweep, num_sweep, local);
+}
+
+/**
+ * Move size and part identification of HQ out of the m5 attribute.
+ * @param t The tile to update.
+ */
+static void MoveHQPartToM3(TileIndex t)
+{
+	/* Check for HQ bit being set, instead of using map accessor,
+	 * since we've already changed it code-wise */
+	if (IsTileType(t, MP_OBJECT) && HasBit(_m[t].m5, 7)) {
+		/* Move size and part identification of HQ out of the m5 attribute,
+		 * on new locations */
+		_m[t].m3 = GB(_m[t].m5, 0, 5);
+		_m[t].m5 = OBJECT_HQ;
+	}
+}
+
+/**
+ * Reorder and generalise the bits of object tiles.
+ * @param t The tile to update.
+ */
+static void ReorderObjectBits(TileIndex t)
+{
+	if (!IsTileType(t, MP_OBJECT)) return;
+
+	/* Reordering/generalisation of the object bits. */
+	ObjectType type = GetObjectType(t);
+	SB(_m[t].m6, 2, 4, type == OBJECT_HQ ? GB(_m[t].m3, 2, 3) : 0);
+	_m[t].m3 = type == OBJECT_HQ ? GB(_m[t].m3, 1, 1) | GB(_m[t].m3, 0, 1) << 4 : 0;
+
+	/* Make sure those bits are clear as well! */
+	_m[t].m4 = 0;
+	_me[t].m7 = 0;
+}
+
+/** Passes over the map for the old HQ and object bits. */
+static const AfterLoadTilePass _object_tile_passes[] = {
+	{  0, 112, ALTPF_TILE_LOCAL, &MoveHQPartToM3 },
+	{  0, 144, ALTPF_TILE_LOCAL, &ReorderObjectBits },
+};
+
+/**
+ * Swap the bits for the tree ground and tree density (m2 bits 7..6 and 5..4),
+ * and move the snow of clear tiles to its own bit.
+ * @param t The tile to update.
+ */
+static void UpdateTreeAndSnowBits(TileIndex t)
+{
+	if (IsTileType(t, MP_CLEAR)) {
+		if (GetRawClearGround(t) == CLEAR_SNOW) {
+			SetClearGroundDensity(t, CLEAR_GRASS, GetClearDensity(t));
+			SetBit(_m[t].m3, 4);
+		} else {
+			ClrBit(_m[t].m3, 4);
+		}
+	}
+	if (IsTileType(t, MP_TREES)) {
+		uint density = GB(_m[t].m2, 6, 2);
+		uint ground = GB(_m[t].m2, 4, 2);
+		uint counter = GB(_m[t].m2, 0, 4);
+		_m[t].m2 = ground << 6 | density << 4 | counter;
+	}
+}
+
+/**
+ * Airport tile animation uses animation frame instead of other graphics id.
+ * @param t The tile to update.
+ */
+static void UpdateAirportTileAnimation(TileIndex t)
+{
+	struct AirportTileConversion {
+		byte old_start;
+		byte num_frames;
+	};
+	static const AirportTileConversion atc[] = {
+		{31,  12}, // APT_RADAR_GRASS_FENCE_SW
+		{50,   4}, // APT_GRASS_FENCE_NE_FLAG
+		{62,   2}, // 1 unused tile
+		{66,  12}, // APT_RADAR_FENCE_SW
+		{78,  12}, // APT_RADAR_FENCE_NE
+		{101, 10}, // 9 unused tiles
+		{111,  8}, // 7 unused tiles
+		{119, 15}, // 14 unused tiles (radar)
+		{140,  4}, // APT_GRASS_FENCE_NE_FLAG_2
+	};
+
+	if (!IsAirportTile(t)) return;
+
+	StationGfx old_gfx = GetStationGfx(t);
+	byte offset = 0;
+	for (uint i = 0; i < lengthof(atc); i++) {
+		if (old_gfx < atc[i].old_start) {
+			SetStationGfx(t, old_gfx - offset);
+			break;
+		}
+		if (old_gfx < atc[i].old_start + atc[i].num_frames) {
+			SetAnimationFrame(t, old_gfx - atc[i].old_start);
+			SetStationGfx(t, atc[i].old_start - offset);
+			break;
+		}
+		offset += atc[i].num_frames - 1;
+	}
+}
+
+/**
+ * Reset tropic zone for VOID tiles, they shall not have any.
+ * @param t The tile to update.
+ */
+static void ResetVoidTropicZone(TileIndex t)
+{
+	if (IsTileType(t, MP_VOID)) SetTropicZone(t, TROPICZONE_NORMAL);
+}
+
+/**
+ * Move the animation frame to the same location (m7) for all objects.
+ * @param t The tile to update.
+ */
+static void MoveAnimationFrameToM7(TileIndex t)
+{
+	switch (GetTileType(t)) {
+		case MP_HOUSE:
+			if (GetHouseType(t) >= NEW_HOUSE_OFFSET) {
+				uint per_proc = _me[t].m7;
+				_me[t].m7 = GB(_m[t].m6, 2, 6) | (GB(_m[t].m3, 5, 1) << 6);
+				SB(_m[t].m3, 5, 1, 0);
+				SB(_m[t].m6, 2, 6, min(per_proc, 63));
+			}
+			break;
+
+		case MP_INDUSTRY: {
+			uint rand = _me[t].m7;
+			_me[t].m7 = _m[t].m3;
+			_m[t].m3 = rand;
+			break;
+		}
+
+		case MP_OBJECT:
+			_me[t].m7 = _m[t].m3;
+			_m[t].m3 = 0;
+			break;
+
+		default:
+			/* For stations/airports it's already at m7 */
+			break;
+	}
+}
+
+/**
+ * Only buoys, oil rigs and flat docks have a water class.
+ * @param t The tile to update.
+ */
+static void ClearStationWaterClass(TileIndex t)
+{
+	if (!IsTileType(t, MP_STATION)) return;
+	if (!IsBuoy(t) && !IsOilRig(t) && !(IsDock(t) && GetTileSlope(t, NULL) == SLOPE_FLAT)) {
+		SetWaterClass(t, WATER_CLASS_INVALID);
+	}
+}
+
+/**
+ * Passes over the map for the conversions of savegame versions 135 up to 149.
+ * None of the vehicle, station, depot and object updates of those versions
+ * look at the bits these change, so they can all be done at once.
+ */
+static const AfterLoadTilePass _late_tile_passes[] = {
+	{  0, 135, ALTPF_TILE_LOCAL, &UpdateTreeAndSnowBits },
+	{  0, 137, ALTPF_TILE_LOCAL, &UpdateAirportTileAnimation },
+	{  0, 141, ALTPF_TILE_LOCAL, &ResetVoidTropicZone },
+	{  0, 147, ALTPF_TILE_LOCAL, &MoveAnimationFrameToM7 },
+	{  0, 149, ALTPF_TILE_LOCAL, &ClearStationWaterClass },
+};
+
 /**
  * Perform a (large) amount of savegame conversion *magic* in order to
  * load older savegames and to fill the caches for various purposes.
@@ -1888,32 +2168,7 @@ bool AfterLoadGame()
 		}
 	}
 
-	if (IsSavegameVersionBefore(112)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			/* Check for HQ bit being set, instead of using map accessor,
-			 * since we've already changed it code-wise */
-			if (IsTileType(t, MP_OBJECT) && HasBit(_m[t].m5, 7)) {
-				/* Move size and part identification of HQ out of the m5 attribute,
-				 * on new locations */
-				_m[t].m3 = GB(_m[t].m5, 0, 5);
-				_m[t].m5 = OBJECT_HQ;
-			}
-		}
-	}
-	if (IsSavegameVersionBefore(144)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (!IsTileType(t, MP_OBJECT)) continue;
-
-			/* Reordering/generalisation of the object bits. */
-			ObjectType type = GetObjectType(t);
-			SB(_m[t].m6, 2, 4, type == OBJECT_HQ ? GB(_m[t].m3, 2, 3) : 0);
-			_m[t].m3 = type == OBJECT_HQ ? GB(_m[t].m3, 1, 1) | GB(_m[t].m3, 0, 1) << 4 : 0;
-
-			/* Make sure those bits are clear as well! */
-			_m[t].m4 = 0;
-			_me[t].m7 = 0;
-		}
-	}
+	RunAfterLoadTilePasses(_object_tile_passes, lengthof(_object_tile_passes));
 
 	if (IsSavegameVersionBefore(147) && Object::GetNumItems() == 0) {
 		/* Make real objects for object tiles. */
@@ -2049,25 +2304,16 @@ bool AfterLoadGame()
 
 	if (IsSavegameVersionBefore(122)) {
 		/* Animated tiles would sometimes not be actually animated or
-		 * in case of old savegames duplicate. */
+		 * in case of old savegames duplicate; the duplicates are
+		 * already dropped while loading. */
 
-		extern TileIndex *_animated_tile_list;
-		extern uint _animated_tile_count;
+		extern void GetAnimatedTiles(SmallVector<TileIndex, 256> *tiles);
+		SmallVector<TileIndex, 256> tiles;
+		GetAnimatedTiles(&tiles);
 
-		for (uint i = 0; i < _animated_tile_count; /* Nothing */) {
+		for (const TileIndex *tile = tiles.Begin(); tile != tiles.End(); tile++) {
 			/* Remove if tile is not animated */
-			bool remove = _tile_type_procs[GetTileType(_animated_tile_list[i])]->animate_tile_proc == NULL;
-
-			/* and remove if duplicate */
-			for (uint j = 0; !remove && j < i; j++) {
-				remove = _animated_tile_list[i] == _animated_tile_list[j];
-			}
-
-			if (remove) {
-				DeleteAnimatedTile(_animated_tile_list[i]);
-			} else {
-				i++;
-			}
+			if (_tile_type_procs[GetTileType(*tile)]->animate_tile_proc == NULL) DeleteAnimatedTile(*tile);
 		}
 	}
 
@@ -2189,26 +2435,7 @@ bool AfterLoadGame()
 		}
 	}
 
-	/* The bits for the tree ground and tree density have
-	 * been swapped (m2 bits 7..6 and 5..4. */
-	if (IsSavegameVersionBefore(135)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsTileType(t, MP_CLEAR)) {
-				if (GetRawClearGround(t) == CLEAR_SNOW) {
-					SetClearGroundDensity(t, CLEAR_GRASS, GetClearDensity(t));
-					SetBit(_m[t].m3, 4);
-				} else {
-					ClrBit(_m[t].m3, 4);
-				}
-			}
-			if (IsTileType(t, MP_TREES)) {
-				uint density = GB(_m[t].m2, 6, 2);
-				uint ground = GB(_m[t].m2, 4, 2);
-				uint counter = GB(_m[t].m2, 0, 4);
-				_m[t].m2 = ground << 6 | density << 4 | counter;
-			}
-		}
-	}
+	RunAfterLoadTilePasses(_late_tile_passes, lengthof(_late_tile_passes));
 
 	/* Wait counter and load/unload ticks got split. */
 	if (IsSavegameVersionBefore(136)) {
@@ -2223,43 +2450,6 @@ bool AfterLoadGame()
 		}
 	}
 
-	/* Airport tile animation uses animation frame instead of other graphics id */
-	if (IsSavegameVersionBefore(137)) {
-		struct AirportTileConversion {
-			byte old_start;
-			byte num_frames;
-		};
-		static const AirportTileConversion atc[] = {
-			{31,  12}, // APT_RADAR_GRASS_FENCE_SW
-			{50,   4}, // APT_GRASS_FENCE_NE_FLAG
-			{62,   2}, // 1 unused tile
-			{66,  12}, // APT_RADAR_FENCE_SW
-			{78,  12}, // APT_RADAR_FENCE_NE
-			{101, 10}, // 9 unused tiles
-			{111,  8}, // 7 unused tiles
-			{119, 15}, // 14 unused tiles (radar)
-			{140,  4}, // APT_GRASS_FENCE_NE_FLAG_2
-		};
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (IsAirportTile(t)) {
-				StationGfx old_gfx = GetStationGfx(t);
-				byte offset = 0;
-				for (uint i = 0; i < lengthof(atc); i++) {
-					if (old_gfx < atc[i].old_start) {
-						SetStationGfx(t, old_gfx - offset);
-						break;
-					}
-					if (old_gfx < atc[i].old_start + atc[i].num_frames) {
-						SetAnimationFrame(t, old_gfx - atc[i].old_start);
-						SetStationGfx(t, atc[i].old_start - offset);
-						break;
-					}
-					offset += atc[i].num_frames - 1;
-				}
-			}
-		}
-	}
-
 	if (IsSavegameVersionBefore(140)) {
 		Station *st;
 		FOR_ALL_STATIONS(st) {
@@ -2271,11 +2461,6 @@ bool AfterLoadGame()
 	}
 
 	if (IsSavegameVersionBefore(141)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			/* Reset tropic zone for VOID tiles, they shall not have any. */
-			if (IsTileType(t, MP_VOID)) SetTropicZone(t, TROPICZONE_NORMAL);
-		}
-
 		/* We need to properly number/name the depots.
 		 * The first step is making sure none of the depots uses the
 		 * 'default' names, after that we can assign the names. */
@@ -2310,38 +2495,6 @@ bool AfterLoadGame()
 		}
 	}
 
-	/* Move the animation frame to the same location (m7) for all objects. */
-	if (IsSavegameVersionBefore(147)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			switch (GetTileType(t)) {
-				case MP_HOUSE:
-					if (GetHouseType(t) >= NEW_HOUSE_OFFSET) {
-						uint per_proc = _me[t].m7;
-						_me[t].m7 = GB(_m[t].m6, 2, 6) | (GB(_m[t].m3, 5, 1) << 6);
-						SB(_m[t].m3, 5, 1, 0);
-						SB(_m[t].m6, 2, 6, min(per_proc, 63));
-					}
-					break;
-
-				case MP_INDUSTRY: {
-					uint rand = _me[t].m7;
-					_me[t].m7 = _m[t].m3;
-					_m[t].m3 = rand;
-					break;
-				}
-
-				case MP_OBJECT:
-					_me[t].m7 = _m[t].m3;
-					_m[t].m3 = 0;
-					break;
-
-				default:
-					/* For stations/airports it's already at m7 */
-					break;
-			}
-		}
-	}
-
 	/* Add (random) colour to all objects. */
 	if (IsSavegameVersionBefore(148)) {
 		Object *o;
@@ -2352,13 +2505,6 @@ bool AfterLoadGame()
 	}
 
 	if (IsSavegameVersionBefore(149)) {
-		for (TileIndex t = 0; t < map_size; t++) {
-			if (!IsTileType(t, MP_STATION)) continue;
-			if (!IsBuoy(t) && !IsOilRig(t) && !(IsDock(t) && GetTileSlope(t, NULL) == SLOPE_FLAT)) {
-				SetWaterClass(t, WATER_CLASS_INVALID);
-			}
-		}
-
 		/* Waypoints with custom name may have a non-unique town_cn,
 		 * renumber those. First set all affected waypoints to the
 		 * highest possible number to get them numbered in the
@@ -2598,6 +2744,9 @@ bool AfterLoadGame()
 	/* Road stops is 'only' updating some caches */
 	AfterLoadRoadStops();
 	AfterLoadLabelMaps();
+	RebuildCompanyVehicleLists();
+	/* The map was changed behind the back of the signal segment cache */
+	InvalidateSignalSegments();
 
 	GamelogPrintDebug(1);
 
@@ -2628,8 +2777,14 @@ void ReloadNewGRFData()
 	SetCachedEngineCounts();
 	/* update station graphics */
 	AfterLoadStations();
+	/* the animation speeds of tiles may have changed */
+	WakeAnimatedTiles();
 	/* Check and update house and town values */
 	UpdateHousesAndTowns();
+	/* the acceptance of tiles may have changed */
+	InvalidateAllStationAcceptance();
+	/* station tiles may have become (non)blocking */
+	InvalidateSignalSegments();
 	/* Delete news referring to no longer existing entities */
 	DeleteInvalidEngineNews();
 	/* Update livery selection windows */
@@ -11,21 +11,23 @@
 
 #include "../stdafx.h"
 #include "../tile_type.h"
-#include "../core/alloc_func.hpp"
+#include "../core/smallvec_type.hpp"
 
 #include "saveload.h"
 
-extern TileIndex *_animated_tile_list;
-extern uint _animated_tile_count;
-extern uint _animated_tile_allocated;
+extern void GetAnimatedTiles(SmallVector<TileIndex, 256> *tiles);
+extern void AppendAnimatedTile(TileIndex tile);
 
 /**
  * Save the ANIT chunk.
  */
 static void Save_ANIT()
 {
-	SlSetLength(_animated_tile_count * sizeof(*_animated_tile_list));
-	SlArray(_animated_tile_list, _animated_tile_count, SLE_UINT32);
+	SmallVector<TileIndex, 256> tiles;
+	GetAnimatedTiles(&tiles);
+
+	SlSetLength(tiles.Length() * sizeof(*tiles.Begin()));
+	SlArray(tiles.Begin(), tiles.Length(), SLE_UINT32);
 }
 
 /**
@@ -33,25 +35,22 @@ static void Save_ANIT()
  */
 static void Load_ANIT()
 {
+	SmallVector<TileIndex, 256> tiles;
+
 	/* Before version 80 we did NOT have a variable length animated tile table */
 	if (IsSavegameVersionBefore(80)) {
 		/* In pre version 6, we has 16bit per tile, now we have 32bit per tile, convert it ;) */
-		SlArray(_animated_tile_list, 256, IsSavegameVersionBefore(6) ? (SLE_FILE_U16 | SLE_VAR_U32) : SLE_UINT32);
+		SlArray(tiles.Append(256), 256, IsSavegameVersionBefore(6) ? (SLE_FILE_U16 | SLE_VAR_U32) : SLE_UINT32);
 
-		for (_animated_tile_count = 0; _animated_tile_count < 256; _animated_tile_count++) {
-			if (_animated_tile_list[_animated_tile_count] == 0) break;
-		}
+		for (uint i = 0; i < 256 && tiles[i] != 0; i++) AppendAnimatedTile(tiles[i]);
 		return;
 	}
 
-	_animated_tile_count = (uint)SlGetFieldLength() / sizeof(*_animated_tile_list);
-
-	/* Determine a nice rounded size for the amount of allocated tiles */
-	_animated_tile_allocated = 256;
-	while (_animated_tile_allocated < _animated_tile_count) _animated_tile_allocated *= 2;
+	uint count = (uint)SlGetFieldLength() / sizeof(*tiles.Begin());
+	SlArray(tiles.Append(count), count, SLE_UINT32);
 
-	_animated_tile_list = ReallocT<TileIndex>(_animated_tile_list, _animated_tile_allocated);
-	SlArray(_animated_tile_list, _animated_tile_count, SLE_UINT32);
+	/* Old savegames may contain duplicates; those are only added once. */
+	for (uint i = 0; i < count; i++) AppendAnimatedTile(tiles[i]);
 }
 
 /**
@@ -95,27 +95,40 @@ static void Save_MAP1()
 
 static void Load_MAP2()
 {
-	SmallStackSafeStackAlloc<uint16, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
+	if (IsSavegameVersionBefore(5)) {
+		/* In those versions the m2 was 8 bits */
+		SmallStackSafeStackAlloc<uint16, MAP_SL_BUF_SIZE> buf;
+		for (TileIndex i = 0; i != size;) {
+			SlArray(buf, MAP_SL_BUF_SIZE, SLE_FILE_U8 | SLE_VAR_U16);
+			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m2 = buf[j];
+		}
+		return;
+	}
+
+	/* The values are stored big endian; read them as bytes, so they are
+	 * copied in bulk instead of being converted one by one. */
+	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE * 2> buf;
 	for (TileIndex i = 0; i != size;) {
-		SlArray(buf, MAP_SL_BUF_SIZE,
-			/* In those versions the m2 was 8 bits */
-			IsSavegameVersionBefore(5) ? SLE_FILE_U8 | SLE_VAR_U16 : SLE_UINT16
-		);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m2 = buf[j];
+		SlArray(buf, MAP_SL_BUF_SIZE * 2, SLE_UINT8);
+		for (uint j = 0; j != MAP_SL_BUF_SIZE * 2; j += 2) _m[i++].m2 = buf[j] << 8 | buf[j + 1];
 	}
 }
 
 static void Save_MAP2()
 {
-	SmallStackSafeStackAlloc<uint16, MAP_SL_BUF_SIZE> buf;
+	SmallStackSafeStackAlloc<byte, MAP_SL_BUF_SIZE * 2> buf;
 	TileIndex size = MapSize();
 
 	SlSetLength(size * sizeof(uint16));
 	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m2;
-		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT16);
+		for (uint j = 0; j != MAP_SL_BUF_SIZE * 2; j += 2) {
+			uint16 m2 = _m[i++].m2;
+			buf[j] = GB(m2, 8, 8);
+			buf[j + 1] = GB(m2, 0, 8);
+		}
+		SlArray(buf, MAP_SL_BUF_SIZE * 2, SLE_UINT8);
 	}
 }
 
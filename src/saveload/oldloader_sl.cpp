@@ -486,8 +486,7 @@ static inline uint RemapOrderIndex(uint x)
 	return _savegame_type == SGT_TTO ? (x - 0x1AC4) / 2 : (x - 0x1C18) / 2;
 }
 
-extern TileIndex *_animated_tile_list;
-extern uint _animated_tile_count;
+extern void AppendAnimatedTile(TileIndex tile);
 extern char *_old_name_array;
 
 static uint32 _old_town_index;
@@ -637,22 +636,21 @@ static bool LoadOldOrder(LoadgameState *ls, int num)
 
 static bool LoadOldAnimTileList(LoadgameState *ls, int num)
 {
-	/* This is sligthly hackish - we must load a chunk into an array whose
-	 * address isn't static, but instead pointed to by _animated_tile_list.
-	 * To achieve that, create an OldChunks list on the stack on the fly.
-	 * The list cannot be static because the value of _animated_tile_list
-	 * can change between calls. */
+	/* This is sligthly hackish - we must load a chunk into an array on
+	 * the stack. To achieve that, create an OldChunks list on the stack
+	 * on the fly. */
+	TileIndex anim_list[256];
 
 	const OldChunks anim_chunk[] = {
-		OCL_VAR (   OC_TILE, 256, _animated_tile_list ),
+		OCL_VAR (   OC_TILE, 256, anim_list ),
 		OCL_END ()
 	};
 
 	if (!LoadChunk(ls, NULL, anim_chunk)) return false;
 
-	/* Update the animated tile counter by counting till the first zero in the array */
-	for (_animated_tile_count = 0; _animated_tile_count < 256; _animated_tile_count++) {
-		if (_animated_tile_list[_animated_tile_count] == 0) break;
+	/* The list ends at the first zero in the array */
+	for (uint i = 0; i < lengthof(anim_list) && anim_list[i] != 0; i++) {
+		AppendAnimatedTile(anim_list[i]);
 	}
 
 	return true;
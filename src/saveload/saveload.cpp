@@ -225,8 +225,9 @@
  *  158   21933
  *  159   21962
  *  160   21974
+ *  161
  */
-extern const uint16 SAVEGAME_VERSION = 160; ///< Current savegame version of OpenTTD.
+extern const uint16 SAVEGAME_VERSION = 161; ///< Current savegame version of OpenTTD.
 
 SavegameType _savegame_type; ///< type of savegame we are loading
 
@@ -270,20 +271,42 @@ struct ReadBuffer {
 	{
 	}
 
-	FORCEINLINE byte ReadByte()
+	/** Fill the buffer with the next bytes from the filter. */
+	void Fill()
 	{
-		if (this->bufp == this->bufe) {
-			size_t len = this->reader->Read(this->buf, lengthof(this->buf));
-			if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
+		size_t len = this->reader->Read(this->buf, lengthof(this->buf));
+		if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
 
-			this->read += len;
-			this->bufp = this->buf;
-			this->bufe = this->buf + len;
-		}
+		this->read += len;
+		this->bufp = this->buf;
+		this->bufe = this->buf + len;
+	}
+
+	FORCEINLINE byte ReadByte()
+	{
+		if (this->bufp == this->bufe) this->Fill();
 
 		return *this->bufp++;
 	}
 
+	/**
+	 * Read a number of bytes in one go.
+	 * @param p      Where to store the bytes.
+	 * @param length The number of bytes to read.
+	 */
+	void ReadBytes(byte *p, size_t length)
+	{
+		while (length > 0) {
+			if (this->bufp == this->bufe) this->Fill();
+
+			size_t to_copy = min((size_t)(this->bufe - this->bufp), length);
+			memcpy(p, this->bufp, to_copy);
+			this->bufp += to_copy;
+			p += to_copy;
+			length -= to_copy;
+		}
+	}
+
 	/**
 	 * Get the size of the memory dump made so far.
 	 * @return The size.
@@ -323,10 +346,32 @@ struct MemoryDumper {
 	}
 
 	/**
-	 * Flush this dumper into a writer.
+	 * Write a number of bytes into the dumper in one go.
+	 * @param p      The bytes to write.
+	 * @param length The number of bytes to write.
+	 */
+	void WriteBytes(const byte *p, size_t length)
+	{
+		while (length > 0) {
+			if (this->buf == this->bufe) {
+				this->buf = CallocT<byte>(MEMORY_CHUNK_SIZE);
+				*this->blocks.Append() = this->buf;
+				this->bufe = this->buf + MEMORY_CHUNK_SIZE;
+			}
+
+			size_t to_copy = min((size_t)(this->bufe - this->buf), length);
+			memcpy(this->buf, p, to_copy);
+			this->buf += to_copy;
+			p += to_copy;
+			length -= to_copy;
+		}
+	}
+
+	/**
+	 * Write the contents of this dumper into a writer, without finishing it.
 	 * @param writer The filter we want to use.
 	 */
-	void Flush(SaveFilter *writer)
+	void Write(SaveFilter *writer)
 	{
 		uint i = 0;
 		size_t t = this->GetSize();
@@ -337,10 +382,37 @@ struct MemoryDumper {
 			writer->Write(this->blocks[i++], to_write);
 			t -= to_write;
 		}
+	}
 
+	/**
+	 * Flush this dumper into a writer.
+	 * @param writer The filter we want to use.
+	 */
+	void Flush(SaveFilter *writer)
+	{
+		this->Write(writer);
 		writer->Finish();
 	}
 
+	/**
+	 * Copy a part of the memory dump to another dumper.
+	 * @param dest   The dumper to copy to.
+	 * @param offset The offset of the first byte to copy.
+	 * @param length The number of bytes to copy.
+	 */
+	void CopyTo(MemoryDumper *dest, size_t offset, size_t length) const
+	{
+		while (length > 0) {
+			const byte *block = this->blocks[offset / MEMORY_CHUNK_SIZE];
+			size_t start = offset % MEMORY_CHUNK_SIZE;
+			size_t to_copy = min(MEMORY_CHUNK_SIZE - start, length);
+
+			dest->WriteBytes(block + start, to_copy);
+			offset += to_copy;
+			length -= to_copy;
+		}
+	}
+
 	/**
 	 * Get the size of the memory dump made so far.
 	 * @return The size.
@@ -351,6 +423,13 @@ struct MemoryDumper {
 	}
 };
 
+/** Where a chunk is in the (uncompressed) savegame, as stored in the chunk directory. */
+struct SavegameChunkPosition {
+	uint32 id;     ///< The identifier of the chunk.
+	uint32 offset; ///< Offset of the chunk from the start of the chunks.
+	uint32 length; ///< Length of the chunk, including its identifier.
+};
+
 /** The saveload struct, containing reader-writer functions, buffer, version, etc. */
 struct SaveLoadParams {
 	SaveLoadAction action;               ///< are we doing a save or a load atm.
@@ -367,6 +446,8 @@ struct SaveLoadParams {
 	ReadBuffer *reader;                  ///< Savegame reading buffer.
 	LoadFilter *lf;                      ///< Filter to read the savegame from.
 
+	SmallVector<SavegameChunkPosition, 64> chunks; ///< The chunk directory of the savegame being saved or loaded.
+
 	StringID error_str;                  ///< the translatable error message to show
 	char *extra_msg;                     ///< the error message
 
@@ -854,10 +935,10 @@ static void SlCopyBytes(void *ptr, size_t length)
 	switch (_sl.action) {
 		case SLA_LOAD_CHECK:
 		case SLA_LOAD:
-			for (; length != 0; length--) *p++ = SlReadByte();
+			_sl.reader->ReadBytes(p, length);
 			break;
 		case SLA_SAVE:
-			for (; length != 0; length--) SlWriteByte(*p++);
+			_sl.dumper->WriteBytes(p, length);
 			break;
 		default: NOT_REACHED();
 	}
@@ -1645,6 +1726,10 @@ static void SlSaveChunk(const ChunkHandler *ch)
 	/* Don't save any chunk information if there is no save handler. */
 	if (proc == NULL) return;
 
+	SavegameChunkPosition *pos = _sl.chunks.Append();
+	pos->id = ch->id;
+	pos->offset = (uint32)_sl.dumper->GetSize();
+
 	SlWriteUint32(ch->id);
 	DEBUG(sl, 2, "Saving chunk %c%c%c%c", ch->id >> 24, ch->id >> 16, ch->id >> 8, ch->id);
 
@@ -1673,11 +1758,14 @@ static void SlSaveChunk(const ChunkHandler *ch)
 			break;
 		default: NOT_REACHED();
 	}
+
+	pos->length = (uint32)_sl.dumper->GetSize() - pos->offset;
 }
 
 /** Save all chunks */
 static void SlSaveChunks()
 {
+	_sl.chunks.Clear();
 	FOR_ALL_CHUNK_HANDLERS(ch) {
 		SlSaveChunk(ch);
 	}
@@ -1698,14 +1786,32 @@ static const ChunkHandler *SlFindChunkHandler(uint32 id)
 	return NULL;
 }
 
+/**
+ * Check whether a chunk is where the chunk directory says it is, when the savegame has one.
+ * @param index The number of chunks before this chunk.
+ * @param id    The identifier of the chunk.
+ */
+static void SlCheckChunkPosition(uint index, uint32 id)
+{
+	if (_sl.chunks.Length() == 0) return;
+
+	/* The identifier of the chunk has just been read. */
+	size_t offset = _sl.reader->GetSize() - sizeof(id);
+	if (index >= _sl.chunks.Length() || _sl.chunks[index].id != id || _sl.chunks[index].offset != offset) {
+		SlErrorCorrupt("Chunk does not match the chunk directory");
+	}
+}
+
 /** Load all chunks */
 static void SlLoadChunks()
 {
 	uint32 id;
 	const ChunkHandler *ch;
+	uint index = 0;
 
 	for (id = SlReadUint32(); id != 0; id = SlReadUint32()) {
 		DEBUG(sl, 2, "Loading chunk %c%c%c%c", id >> 24, id >> 16, id >> 8, id);
+		SlCheckChunkPosition(index++, id);
 
 		ch = SlFindChunkHandler(id);
 		if (ch == NULL) SlErrorCorrupt("Unknown chunk type");
@@ -1728,6 +1834,123 @@ static void SlLoadCheckChunks()
 	}
 }
 
+/**
+ * Write the metadata of the savegame: the chunk directory, followed by a
+ * copy of the chunks needed to preview the savegame. It is written before
+ * the compressed chunks and is not compressed itself, so previewing does
+ * not need to decompress the whole savegame.
+ * @param writer The filter to write the metadata to.
+ */
+static void SlWriteMetadata(SaveFilter *writer)
+{
+	MemoryDumper *game = _sl.dumper;
+	MemoryDumper metadata;
+	_sl.dumper = &metadata;
+
+	SlWriteUint32(_sl.chunks.Length());
+	for (const SavegameChunkPosition *pos = _sl.chunks.Begin(); pos != _sl.chunks.End(); pos++) {
+		SlWriteUint32(pos->id);
+		SlWriteUint32(pos->offset);
+		SlWriteUint32(pos->length);
+	}
+
+	for (const SavegameChunkPosition *pos = _sl.chunks.Begin(); pos != _sl.chunks.End(); pos++) {
+		const ChunkHandler *ch = SlFindChunkHandler(pos->id);
+		if (ch->load_check_proc != NULL) game->CopyTo(&metadata, pos->offset, pos->length);
+	}
+	SlWriteUint32(0);
+
+	_sl.dumper = game;
+
+	uint32 length = TO_BE32((uint32)metadata.GetSize());
+	writer->Write((byte *)&length, sizeof(length));
+	metadata.Write(writer);
+}
+
+/** Filter reading the metadata of a savegame from memory. */
+struct MetadataReader : LoadFilter {
+	byte *buf;   ///< The metadata.
+	uint32 size; ///< The size of the metadata.
+	uint32 pos;  ///< The amount of metadata read so far.
+
+	/**
+	 * Serve metadata that was read from the savegame already.
+	 * @param chain The filter the savegame was read from.
+	 * @param buf   The metadata; the reader takes ownership of it.
+	 * @param size  The size of the metadata.
+	 */
+	MetadataReader(LoadFilter *chain, byte *buf, uint32 size) : LoadFilter(chain), buf(buf), size(size), pos(0)
+	{
+	}
+
+	/** Free the metadata. */
+	~MetadataReader()
+	{
+		free(this->buf);
+	}
+
+	/* virtual */ size_t Read(byte *buf, size_t size)
+	{
+		size = min<size_t>(size, this->size - this->pos);
+		memcpy(buf, this->buf + this->pos, size);
+		this->pos += (uint32)size;
+		return size;
+	}
+
+	/* virtual */ void Reset()
+	{
+		this->pos = 0;
+	}
+};
+
+/**
+ * Read the metadata of the savegame, which is directly after the header.
+ * @param load_check Whether to load the chunks for previewing the savegame from it.
+ */
+static void SlReadMetadata(bool load_check)
+{
+	/* The chunk directory and the preview chunks are far smaller than this. */
+	static const uint32 MAX_METADATA_SIZE = 64 << 20;
+
+	uint32 length;
+	if (_sl.lf->Read((byte *)&length, sizeof(length)) != sizeof(length)) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+	length = FROM_BE32(length);
+	if (length > MAX_METADATA_SIZE) SlErrorCorrupt("Savegame metadata too large");
+
+	/* Read the whole block before handing it to a filter, so nothing is owned twice when the file is cut short. */
+	byte *buf = MallocT<byte>(length);
+	for (uint32 read = 0; read < length;) {
+		size_t len = _sl.lf->Read(buf + read, length - read);
+		if (len == 0) {
+			free(buf);
+			SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+		}
+		read += (uint32)len;
+	}
+
+	/* Let the metadata reader own the file while reading from it, so it gets cleaned up on errors. */
+	MetadataReader *metadata = new MetadataReader(_sl.lf, buf, length);
+	_sl.lf = metadata;
+	_sl.reader = new ReadBuffer(metadata);
+
+	uint count = SlReadUint32();
+	for (uint i = 0; i < count; i++) {
+		SavegameChunkPosition *pos = _sl.chunks.Append();
+		pos->id = SlReadUint32();
+		pos->offset = SlReadUint32();
+		pos->length = SlReadUint32();
+	}
+	DEBUG(sl, 2, "Savegame has %u chunks", count);
+
+	if (load_check) SlLoadCheckChunks();
+
+	delete _sl.reader;
+	_sl.reader = NULL;
+	_sl.lf = metadata->chain;
+	metadata->chain = NULL;
+	delete metadata;
+}
+
 /** Fix all pointers (convert index -> pointer) */
 static void SlFixPointers()
 {
@@ -2399,6 +2622,7 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 		/* We have written our stuff to memory, now write it to file! */
 		uint32 hdr[2] = { fmt->tag, TO_BE32(SAVEGAME_VERSION << 16) };
 		_sl.sf->Write((byte*)hdr, sizeof(hdr));
+		SlWriteMetadata(_sl.sf);
 
 		_sl.sf = fmt->init_write(_sl.sf, compression);
 		_sl.dumper->Flush(_sl.sf);
@@ -2507,6 +2731,7 @@ SaveOrLoadResult SaveWithFilter(SaveFilter *writer, bool threaded)
 static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 {
 	_sl.lf = reader;
+	_sl.chunks.Clear();
 
 	if (load_check) {
 		/* Clear previous check data */
@@ -2567,8 +2792,15 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 		SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, err_str);
 	}
 
-	_sl.lf = fmt->init_load(_sl.lf);
-	_sl.reader = new ReadBuffer(_sl.lf);
+	/* Since version 161 the metadata is between the header and the compressed chunks. */
+	bool has_metadata = !IsSavegameVersionBefore(161);
+	if (has_metadata) SlReadMetadata(load_check);
+
+	/* Previewing savegames with metadata does not need the compressed chunks at all. */
+	if (!load_check || !has_metadata) {
+		_sl.lf = fmt->init_load(_sl.lf);
+		_sl.reader = new ReadBuffer(_sl.lf);
+	}
 	_next_offs = 0;
 
 	if (!load_check) {
@@ -2608,9 +2840,9 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 	}
 
 	if (load_check) {
-		/* Load chunks into _load_check_data.
+		/* Load chunks into _load_check_data, unless that was done from the metadata.
 		 * No pools are loaded. References are not possible, and thus do not need resolving. */
-		SlLoadCheckChunks();
+		if (!has_metadata) SlLoadCheckChunks();
 	} else {
 		/* Load chunks and resolve references */
 		SlLoadChunks();
@@ -24,6 +24,7 @@
 #include "window_gui.h"
 #include "window_func.h"
 #include "tile_map.h"
+#include "console_func.h"
 
 #include "table/strings.h"
 
@@ -227,6 +228,8 @@ static bool MakeBMPImage(const char *name, ScreenshotCallback *callb, void *user
  *********************************************************/
 #if defined(WITH_PNG)
 #include <png.h>
+#include "thread/thread.h"
+#include "thread/spsc_queue.hpp"
 
 #ifdef PNG_TEXT_SUPPORTED
 #include "rev.h"
@@ -247,6 +250,107 @@ static void PNGAPI png_my_warning(png_structp png_ptr, png_const_charp message)
 	DEBUG(misc, 1, "[libpng] warning: %s - %s", message, (const char *)png_get_error_ptr(png_ptr));
 }
 
+/** Number of rendered strips that can be waiting for the PNG writer thread. */
+static const uint PNG_STRIPS_IN_FLIGHT = 4;
+
+/** A strip of rendered lines of a PNG image. */
+struct PNGStrip {
+	uint8 *buf; ///< The pixels of the lines.
+	uint n;     ///< The number of lines; 0 tells the writer thread to stop.
+};
+
+/**
+ * Queue of strips handed between the threads. It must be able to hold all
+ * strips in flight and the strip telling the writer thread to stop, and
+ * a #SPSCQueue holds one item less than its capacity.
+ */
+typedef SPSCQueue<PNGStrip, PNG_STRIPS_IN_FLIGHT + 2> PNGStripQueue;
+
+/**
+ * Compressing and writing a PNG image on a separate thread, so the next
+ * strip can be rendered meanwhile. Rendering itself has to stay on the
+ * game thread, as the sprite cache and the drawing code are not thread safe.
+ */
+struct PNGWriter {
+	png_structp png_ptr;   ///< The image being written.
+	uint row_size;         ///< The number of bytes of a line.
+	ThreadMutex *mutex;    ///< Wakes up the threads when a strip is handed over.
+	PNGStripQueue rendered; ///< Strips waiting to be written.
+	PNGStripQueue written;  ///< Strips that can be rendered into again.
+	PNGStrip current;      ///< The strip the writer thread is busy with.
+	volatile bool failed;  ///< Whether libpng failed on the writer thread.
+	char error_msg[128];   ///< The error of libpng, if it failed.
+
+	/**
+	 * Hand a strip to the other thread.
+	 * @param queue The queue to put the strip in.
+	 * @param strip The strip.
+	 */
+	void Give(PNGStripQueue &queue, const PNGStrip &strip)
+	{
+		this->mutex->BeginCritical();
+		bool pushed = queue.Push(strip);
+		assert(pushed);
+		this->mutex->SendSignal();
+		this->mutex->EndCritical();
+	}
+
+	/**
+	 * Wait for a strip from the other thread.
+	 * @param queue The queue to take the strip from.
+	 * @return The strip.
+	 */
+	PNGStrip Take(PNGStripQueue &queue)
+	{
+		PNGStrip strip;
+		this->mutex->BeginCritical();
+		while (!queue.Pop(&strip)) this->mutex->WaitForSignal();
+		this->mutex->EndCritical();
+		return strip;
+	}
+};
+
+/** libpng error handler of the writer thread; logging is left to the game thread. */
+static void PNGAPI png_writer_error(png_structp png_ptr, png_const_charp message)
+{
+	PNGWriter *writer = (PNGWriter *)png_get_error_ptr(png_ptr);
+	strecpy(writer->error_msg, message, lastof(writer->error_msg));
+	longjmp(png_jmpbuf(png_ptr), 1);
+}
+
+/** libpng warning handler of the writer thread; warnings are dropped. */
+static void PNGAPI png_writer_warning(png_structp png_ptr, png_const_charp message)
+{
+}
+
+/**
+ * Main loop of the PNG writer thread; writes rendered strips until told to stop.
+ * @param arg The #PNGWriter.
+ */
+static void PNGWriterThread(void *arg)
+{
+	PNGWriter *writer = (PNGWriter *)arg;
+
+	png_set_error_fn(writer->png_ptr, writer, png_writer_error, png_writer_warning);
+	if (setjmp(png_jmpbuf(writer->png_ptr))) {
+		/* Keep handing back the strips, so the game thread can finish rendering. */
+		writer->failed = true;
+		writer->Give(writer->written, writer->current);
+	}
+
+	for (;;) {
+		writer->current = writer->Take(writer->rendered);
+		if (writer->current.n == 0) break;
+
+		if (!writer->failed) {
+			for (uint i = 0; i != writer->current.n; i++) {
+				png_write_row(writer->png_ptr, (png_bytep)writer->current.buf + i * writer->row_size);
+			}
+		}
+		writer->Give(writer->written, writer->current);
+	}
+}
+
 /**
  * Generic .PNG file image writer.
  * @param name        Filename, including extension.
@@ -375,28 +479,86 @@ static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *user
 	/* use by default 64k temp memory */
 	maxlines = Clamp(65536 / w, 16, 128);
 
-	/* now generate the bitmap bits */
-	void *buff = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
+	/* Compress and write the image while rendering it, when it takes more than one go. */
+	PNGWriter writer;
+	ThreadObject *thread = NULL;
+	if (h > maxlines) {
+		writer.png_ptr = png_ptr;
+		writer.row_size = w * bpp;
+		writer.mutex = ThreadMutex::New();
+		writer.failed = false;
+		for (i = 0; i != PNG_STRIPS_IN_FLIGHT; i++) {
+			PNGStrip strip = { CallocT<uint8>(w * maxlines * bpp), 0 };
+			bool pushed = writer.written.Push(strip);
+			assert(pushed);
+		}
+		if (!ThreadObject::New(&PNGWriterThread, &writer, &thread)) {
+			thread = NULL;
+			PNGStrip strip;
+			while (writer.written.Pop(&strip)) free(strip.buf);
+			delete writer.mutex;
+		}
+	}
 
-	y = 0;
-	do {
-		/* determine # lines to write */
-		n = min(h - y, maxlines);
+	if (thread != NULL) {
+		for (y = 0; y != h; y += n) {
+			n = min(h - y, maxlines);
 
-		/* render the pixels into the buffer */
-		callb(userdata, buff, y, w, n);
-		y += n;
+			PNGStrip strip = writer.Take(writer.written);
+			if (!writer.failed) callb(userdata, strip.buf, y, w, n);
+			strip.n = n;
+			writer.Give(writer.rendered, strip);
+		}
 
-		/* write them to png */
-		for (i = 0; i != n; i++) {
-			png_write_row(png_ptr, (png_bytep)buff + i * w * bpp);
+		PNGStrip stop = { NULL, 0 };
+		writer.Give(writer.rendered, stop);
+		thread->Join();
+		delete thread;
+
+		for (i = 0; i != PNG_STRIPS_IN_FLIGHT; i++) {
+			PNGStrip strip;
+			writer.written.Pop(&strip);
+			free(strip.buf);
 		}
-	} while (y != h);
+		delete writer.mutex;
+
+		png_set_error_fn(png_ptr, (void *)name, png_my_error, png_my_warning);
+		if (writer.failed) {
+			DEBUG(misc, 0, "[libpng] error: %s - %s", writer.error_msg, name);
+			png_destroy_write_struct(&png_ptr, &info_ptr);
+			fclose(f);
+			return false;
+		}
+		if (setjmp(png_jmpbuf(png_ptr))) {
+			png_destroy_write_struct(&png_ptr, &info_ptr);
+			fclose(f);
+			return false;
+		}
+	} else {
+		/* now generate the bitmap bits */
+		void *buff = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
+
+		y = 0;
+		do {
+			/* determine # lines to write */
+			n = min(h - y, maxlines);
+
+			/* render the pixels into the buffer */
+			callb(userdata, buff, y, w, n);
+			y += n;
+
+			/* write them to png */
+			for (i = 0; i != n; i++) {
+				png_write_row(png_ptr, (png_bytep)buff + i * w * bpp);
+			}
+		} while (y != h);
+
+		free(buff);
+	}
 
 	png_write_end(png_ptr, info_ptr);
 	png_destroy_write_struct(&png_ptr, &info_ptr);
 
-	free(buff);
 	fclose(f);
 	return true;
 }
@@ -685,6 +847,34 @@ static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, ui
 	_screen_disable_anim = old_disable_anim;
 }
 
+/** Rendering of a large screenshot, of which the progress is reported in the console. */
+struct ScreenshotProgress {
+	ScreenshotCallback *callb; ///< The callback doing the actual rendering.
+	void *userdata;            ///< The user data of #callb.
+	uint height;               ///< The height of the screenshot.
+	uint done;                 ///< The number of lines rendered so far.
+	uint reported;             ///< The last percentage that was reported.
+};
+
+/**
+ * Render some lines of a large screenshot, and tell the console about every
+ * ten percent of progress.
+ * @param userdata The #ScreenshotProgress.
+ * @see ScreenshotCallback
+ */
+static void ProgressCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
+{
+	ScreenshotProgress *progress = (ScreenshotProgress *)userdata;
+	progress->callb(progress->userdata, buf, y, pitch, n);
+
+	progress->done += n;
+	uint percent = (uint)((uint64)progress->done * 100 / progress->height);
+	if (percent / 10 != progress->reported / 10) {
+		progress->reported = percent;
+		IConsolePrintF(CC_DEFAULT, "Screenshot: %u%% done", percent);
+	}
+}
+
 /**
  * Construct a pathname for a screenshot file.
  * @param default_fn Default filename.
@@ -772,8 +962,11 @@ static bool MakeWorldScreenshot()
 	vp.virtual_height = ((MapMaxX() + MapMaxY()) * TILE_PIXELS >> 1) + extra_height_top - reclaim_height_bottom;
 	vp.height = vp.virtual_height;
 
+	/* This can take a long time, so keep the user informed. */
+	ScreenshotProgress progress = { LargeWorldCallback, &vp, (uint)vp.height, 0, 0 };
+
 	sf = _screenshot_formats + _cur_screenshot_format;
-	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), LargeWorldCallback, &vp, vp.width, vp.height,
+	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), ProgressCallback, &progress, vp.width, vp.height,
 			BlitterFactoryBase::GetCurrentBlitter()->GetScreenDepth(), _cur_palette);
 }
 
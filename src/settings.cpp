@@ -719,6 +719,7 @@ static bool RedrawSmallmap(int32 p1)
 {
 	BuildLandLegend();
 	BuildOwnerLegend();
+	InvalidateSmallMapCache();
 	SetWindowClassesDirty(WC_SMALLMAP);
 	return true;
 }
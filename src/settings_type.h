@@ -195,6 +195,7 @@ struct NetworkSettings {
 	char   last_host[NETWORK_HOSTNAME_LENGTH];            ///< IP address of the last joined server
 	uint16 last_port;                                     ///< port of the last joined server
 	bool   no_http_content_downloads;                     ///< do not do content downloads over HTTP
+	bool   io_thread;                                     ///< do the socket work of the server's connections on a separate thread
 #else /* ENABLE_NETWORK */
 #endif
 };
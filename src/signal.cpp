@@ -17,6 +17,7 @@
 #include "viewport_func.h"
 #include "train.h"
 #include "company_base.h"
+#include "core/smallvec_type.hpp"
 
 
 /** these are the maximums used for updating signal blocks */
@@ -187,6 +188,62 @@ static SmallSet<DiagDirection, SIG_TBD_SIZE> _tbdset("_tbdset");    ///< set of
 static SmallSet<DiagDirection, SIG_GLOB_SIZE> _globset("_globset"); ///< set of places to be updated in following runs
 
 
+/** Number of signal segments whose layout is remembered; must be a power of 2. */
+static const uint SIG_SEGMENT_CACHE_SIZE = 1024;
+
+uint32 _signal_segment_version = 1; ///< Increased whenever the rail network changes; see InvalidateSignalSegments().
+
+/** A tile and a direction, as used by the sets above. */
+struct SignalSegmentItem {
+	TileIndex tile; ///< The tile.
+	byte dir;       ///< The DiagDirection or Trackdir.
+};
+
+/** A tile to check for trains. */
+struct SignalSegmentTile {
+	TileIndex tile;    ///< The tile.
+	TrackBits tracks;  ///< The tracks to check; TRACK_BIT_NONE for any train on the tile.
+};
+
+/**
+ * The layout of a signal segment as found by ExploreSegment(). It contains
+ * everything needed to evaluate the segment again without exploring it, as
+ * long as the rail network does not change. The index of the segment in
+ * #_signal_segments is its ID.
+ */
+struct SignalSegment {
+	TileIndex tile;        ///< Tile of the entry in _globset the segment was explored from.
+	DiagDirection side;    ///< Side of the entry in _globset the segment was explored from.
+	Owner owner;           ///< Owner whose signals were explored.
+	uint32 version;        ///< #_signal_segment_version when the segment was explored; 0 when unused.
+	bool pbs;              ///< Whether the segment has path signals.
+	SmallVector<SignalSegmentTile, 16> tiles;    ///< Tiles to check for trains, in the order of exploring.
+	SmallVector<SignalSegmentItem, 4> signals;   ///< Signals facing into the segment, in the order they were added to _tbuset.
+	SmallVector<SignalSegmentItem, 4> exits;     ///< Presignal exits leading out of the segment.
+	SmallVector<SignalSegmentItem, 32> visited;  ///< Tile sides passed while exploring, in the order they were removed from _globset.
+};
+
+static SignalSegment _signal_segments[SIG_SEGMENT_CACHE_SIZE]; ///< The remembered signal segments.
+
+/** Forget all remembered signal segments and start counting versions anew; used when the version wraps. */
+void ResetSignalSegments()
+{
+	for (uint i = 0; i < SIG_SEGMENT_CACHE_SIZE; i++) _signal_segments[i].version = 0;
+	_signal_segment_version = 1;
+}
+
+/**
+ * Get the ID of the signal segment explored from an entry in _globset.
+ * @param tile Tile of the entry.
+ * @param side Side of the entry.
+ * @param owner Owner whose signals are updated.
+ * @return The ID of the segment; the segment may describe another entry.
+ */
+static inline uint GetSignalSegmentID(TileIndex tile, DiagDirection side, Owner owner)
+{
+	return (tile * 5 + side + owner * 7919) & (SIG_SEGMENT_CACHE_SIZE - 1);
+}
+
 /** Check whether there is a train on rail, not in a depot */
 static Vehicle *TrainOnTileEnum(Vehicle *v, void *)
 {
@@ -207,13 +264,22 @@ static Vehicle *TrainOnTileEnum(Vehicle *v, void *)
  * @param d1 direction (tile side) we are entering
  * @param t2 tile we are leaving
  * @param d2 direction (tile side) we are leaving
+ * @param seg segment to record the removals from _globset in, or NULL
  * @return false iff reverse direction was in Todo set
  */
-static inline bool CheckAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2)
+static inline bool CheckAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2, SignalSegment *seg)
 {
 	_globset.Remove(t1, d1); // it can be in Global but not in Todo
 	_globset.Remove(t2, d2); // remove in all cases
 
+	if (seg != NULL) {
+		SignalSegmentItem *item = seg->visited.Append(2);
+		item[0].tile = t1;
+		item[0].dir = d1;
+		item[1].tile = t2;
+		item[1].dir = d2;
+	}
+
 	assert(!_tbdset.IsIn(t1, d1)); // it really shouldn't be there already
 
 	if (_tbdset.Remove(t2, d2)) return false;
@@ -233,11 +299,12 @@ static inline bool CheckAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t
  * @param d1 direction (tile side) we are entering
  * @param t2 tile we are leaving
  * @param d2 direction (tile side) we are leaving
+ * @param seg segment to record the removals from Global set in, or NULL
  * @return false iff the Todo buffer would be overrun
  */
-static inline bool MaybeAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2)
+static inline bool MaybeAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2, SignalSegment *seg)
 {
-	if (!CheckAddToTodoSet(t1, d1, t2, d2)) return true;
+	if (!CheckAddToTodoSet(t1, d1, t2, d2, seg)) return true;
 
 	return _tbdset.Add(t1, d1);
 }
@@ -258,13 +325,61 @@ enum SigFlags {
 DECLARE_ENUM_AS_BIT_SET(SigFlags)
 
 
+/**
+ * Check a tile of the signal segment for trains, unless a train was found already
+ *
+ * @param tile tile to check
+ * @param tracks tracks to check, TRACK_BIT_NONE for any train on the tile
+ * @param flags info about the segment so far
+ * @param seg segment to record the check in, or NULL
+ * @return flags, with SF_TRAIN set when a train was found
+ */
+static inline SigFlags CheckSegmentTile(TileIndex tile, TrackBits tracks, SigFlags flags, SignalSegment *seg)
+{
+	if (seg != NULL) {
+		SignalSegmentTile *st = seg->tiles.Append();
+		st->tile = tile;
+		st->tracks = tracks;
+	}
+
+	if (flags & SF_TRAIN) return flags;
+
+	bool train = (tracks == TRACK_BIT_NONE) ? HasVehicleOnPos(tile, NULL, &TrainOnTileEnum) : EnsureNoTrainOnTrackBits(tile, tracks).Failed();
+	return train ? flags | SF_TRAIN : flags;
+}
+
+
+/**
+ * Count a presignal exit leading out of the segment, unless two green exits were found already
+ *
+ * @param tile tile of the exit
+ * @param trackdir trackdir of the exit signal
+ * @param flags info about the segment so far
+ * @return flags, with the exit counted
+ */
+static inline SigFlags AddPresignalExit(TileIndex tile, Trackdir trackdir, SigFlags flags)
+{
+	if (flags & SF_GREEN2) return flags;
+
+	if (flags & SF_EXIT) flags |= SF_EXIT2; // found two (or more) exits
+	flags |= SF_EXIT; // found at least one exit - allow for compiler optimizations
+	if (GetSignalStateByTrackdir(tile, trackdir) == SIGNAL_STATE_GREEN) { // found green presignal exit
+		if (flags & SF_GREEN) flags |= SF_GREEN2;
+		flags |= SF_GREEN;
+	}
+
+	return flags;
+}
+
+
 /**
  * Search signal block
  *
  * @param owner owner whose signals we are updating
+ * @param seg segment to record the layout of the block in, or NULL
  * @return SigFlags
  */
-static SigFlags ExploreSegment(Owner owner)
+static SigFlags ExploreSegment(Owner owner, SignalSegment *seg)
 {
 	SigFlags flags = SF_NONE;
 
@@ -281,13 +396,13 @@ static SigFlags ExploreSegment(Owner owner)
 
 				if (IsRailDepot(tile)) {
 					if (enterdir == INVALID_DIAGDIR) { // from 'inside' - train just entered or left the depot
-						if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, NULL, &TrainOnTileEnum)) flags |= SF_TRAIN;
+						flags = CheckSegmentTile(tile, TRACK_BIT_NONE, flags, seg);
 						exitdir = GetRailDepotDirection(tile);
 						tile += TileOffsByDiagDir(exitdir);
 						enterdir = ReverseDiagDir(exitdir);
 						break;
 					} else if (enterdir == GetRailDepotDirection(tile)) { // entered a depot
-						if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, NULL, &TrainOnTileEnum)) flags |= SF_TRAIN;
+						flags = CheckSegmentTile(tile, TRACK_BIT_NONE, flags, seg);
 						continue;
 					} else {
 						continue;
@@ -299,11 +414,10 @@ static SigFlags ExploreSegment(Owner owner)
 
 				if (tracks == TRACK_BIT_HORZ || tracks == TRACK_BIT_VERT) { // there is exactly one incidating track, no need to check
 					tracks = tracks_masked;
-					/* If no train detected yet, and there is not no train -> there is a train -> set the flag */
-					if (!(flags & SF_TRAIN) && EnsureNoTrainOnTrackBits(tile, tracks).Failed()) flags |= SF_TRAIN;
+					flags = CheckSegmentTile(tile, tracks, flags, seg);
 				} else {
 					if (tracks_masked == TRACK_BIT_NONE) continue; // no incidating track
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, NULL, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					flags = CheckSegmentTile(tile, TRACK_BIT_NONE, flags, seg);
 				}
 
 				if (HasSignals(tile)) { // there is exactly one track - not zero, because there is exit from this tile
@@ -320,18 +434,22 @@ static SigFlags ExploreSegment(Owner owner)
 								flags |= SF_PBS;
 							} else if (!_tbuset.Add(tile, reversedir)) {
 								return flags | SF_FULL;
+							} else if (seg != NULL) {
+								SignalSegmentItem *item = seg->signals.Append();
+								item->tile = tile;
+								item->dir = reversedir;
 							}
 						}
 						if (HasSignalOnTrackdir(tile, trackdir) && !IsOnewaySignal(tile, track)) flags |= SF_PBS;
 
-						/* if it is a presignal EXIT in OUR direction and we haven't found 2 green exits yes, do special check */
-						if (!(flags & SF_GREEN2) && IsPresignalExit(tile, track) && HasSignalOnTrackdir(tile, trackdir)) { // found presignal exit
-							if (flags & SF_EXIT) flags |= SF_EXIT2; // found two (or more) exits
-							flags |= SF_EXIT; // found at least one exit - allow for compiler optimizations
-							if (GetSignalStateByTrackdir(tile, trackdir) == SIGNAL_STATE_GREEN) { // found green presignal exit
-								if (flags & SF_GREEN) flags |= SF_GREEN2;
-								flags |= SF_GREEN;
+						/* if it is a presignal EXIT in OUR direction, do special check */
+						if (IsPresignalExit(tile, track) && HasSignalOnTrackdir(tile, trackdir)) { // found presignal exit
+							if (seg != NULL) {
+								SignalSegmentItem *item = seg->exits.Append();
+								item->tile = tile;
+								item->dir = trackdir;
 							}
+							flags = AddPresignalExit(tile, trackdir, flags);
 						}
 
 						continue;
@@ -342,7 +460,7 @@ static SigFlags ExploreSegment(Owner owner)
 					if (dir != enterdir && (tracks & _enterdir_to_trackbits[dir])) { // any track incidating?
 						TileIndex newtile = tile + TileOffsByDiagDir(dir);  // new tile to check
 						DiagDirection newdir = ReverseDiagDir(dir); // direction we are entering from
-						if (!MaybeAddToTodoSet(newtile, newdir, tile, dir)) return flags | SF_FULL;
+						if (!MaybeAddToTodoSet(newtile, newdir, tile, dir, seg)) return flags | SF_FULL;
 					}
 				}
 
@@ -355,7 +473,7 @@ static SigFlags ExploreSegment(Owner owner)
 				if (DiagDirToAxis(enterdir) != GetRailStationAxis(tile)) continue; // different axis
 				if (IsStationTileBlocked(tile)) continue; // 'eye-candy' station tile
 
-				if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, NULL, &TrainOnTileEnum)) flags |= SF_TRAIN;
+				flags = CheckSegmentTile(tile, TRACK_BIT_NONE, flags, seg);
 				tile += TileOffsByDiagDir(exitdir);
 				break;
 
@@ -364,7 +482,7 @@ static SigFlags ExploreSegment(Owner owner)
 				if (GetTileOwner(tile) != owner) continue;
 				if (DiagDirToAxis(enterdir) == GetCrossingRoadAxis(tile)) continue; // different axis
 
-				if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, NULL, &TrainOnTileEnum)) flags |= SF_TRAIN;
+				flags = CheckSegmentTile(tile, TRACK_BIT_NONE, flags, seg);
 				tile += TileOffsByDiagDir(exitdir);
 				break;
 
@@ -374,13 +492,13 @@ static SigFlags ExploreSegment(Owner owner)
 				DiagDirection dir = GetTunnelBridgeDirection(tile);
 
 				if (enterdir == INVALID_DIAGDIR) { // incoming from the wormhole
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, NULL, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					flags = CheckSegmentTile(tile, TRACK_BIT_NONE, flags, seg);
 					enterdir = dir;
 					exitdir = ReverseDiagDir(dir);
 					tile += TileOffsByDiagDir(exitdir); // just skip to next tile
 				} else { // NOT incoming from the wormhole!
 					if (ReverseDiagDir(enterdir) != dir) continue;
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, NULL, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					flags = CheckSegmentTile(tile, TRACK_BIT_NONE, flags, seg);
 					tile = GetOtherTunnelBridgeEnd(tile); // just skip to exit tile
 					enterdir = INVALID_DIAGDIR;
 					exitdir = INVALID_DIAGDIR;
@@ -392,7 +510,39 @@ static SigFlags ExploreSegment(Owner owner)
 				continue; // continue the while() loop
 		}
 
-		if (!MaybeAddToTodoSet(tile, enterdir, oldtile, exitdir)) return flags | SF_FULL;
+		if (!MaybeAddToTodoSet(tile, enterdir, oldtile, exitdir, seg)) return flags | SF_FULL;
+	}
+
+	return flags;
+}
+
+
+/**
+ * Evaluate a signal block from its remembered layout
+ * This has the same effect on the sets as ExploreSegment() would have,
+ * without visiting all tiles of the block again.
+ *
+ * @param seg remembered layout of the block
+ * @return SigFlags
+ */
+static SigFlags ReplaySegment(const SignalSegment *seg)
+{
+	SigFlags flags = seg->pbs ? SF_PBS : SF_NONE;
+
+	for (const SignalSegmentItem *item = seg->visited.Begin(); item != seg->visited.End() && !_globset.IsEmpty(); item++) {
+		_globset.Remove(item->tile, (DiagDirection)item->dir);
+	}
+
+	for (const SignalSegmentTile *st = seg->tiles.Begin(); st != seg->tiles.End() && !(flags & SF_TRAIN); st++) {
+		flags = CheckSegmentTile(st->tile, st->tracks, flags, NULL);
+	}
+
+	for (const SignalSegmentItem *item = seg->signals.Begin(); item != seg->signals.End(); item++) {
+		_tbuset.Add(item->tile, (Trackdir)item->dir);
+	}
+
+	for (const SignalSegmentItem *item = seg->exits.Begin(); item != seg->exits.End(); item++) {
+		flags = AddPresignalExit(item->tile, (Trackdir)item->dir, flags);
 	}
 
 	return flags;
@@ -450,6 +600,20 @@ static void UpdateSignalsAroundSegment(SigFlags flags)
 }
 
 
+/**
+ * Get the state of a signal segment
+ *
+ * @param flags info about segment
+ * @return state of the segment
+ */
+static inline SigSegState GetSigSegState(SigFlags flags)
+{
+	if (flags & SF_PBS) return SIGSEG_PBS;
+	if ((flags & SF_TRAIN) || ((flags & SF_EXIT) && !(flags & SF_GREEN)) || (flags & SF_FULL)) return SIGSEG_FULL;
+	return SIGSEG_FREE;
+}
+
+
 /** Reset all sets after one set overflowed */
 static inline void ResetSets()
 {
@@ -480,6 +644,27 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 		assert(_tbuset.IsEmpty());
 		assert(_tbdset.IsEmpty());
 
+		SignalSegment *seg = &_signal_segments[GetSignalSegmentID(tile, dir, owner)];
+		if (seg->version == _signal_segment_version && seg->tile == tile && seg->side == dir && seg->owner == owner) {
+			/* The rail network did not change since this block was explored from here. */
+			SigFlags flags = ReplaySegment(seg);
+			if (first) {
+				first = false;
+				state = GetSigSegState(flags);
+			}
+			UpdateSignalsAroundSegment(flags);
+			continue;
+		}
+
+		seg->tile = tile;
+		seg->side = dir;
+		seg->owner = owner;
+		seg->version = 0;
+		seg->tiles.Clear();
+		seg->signals.Clear();
+		seg->exits.Clear();
+		seg->visited.Clear();
+
 		/* After updating signal, data stored are always MP_RAILWAY with signals.
 		 * Other situations happen when data are from outside functions -
 		 * modification of railbits (including both rail building and removal),
@@ -526,16 +711,11 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 		assert(!_tbdset.Overflowed()); // it really shouldn't overflow by these one or two items
 		assert(!_tbdset.IsEmpty()); // it wouldn't hurt anyone, but shouldn't happen too
 
-		SigFlags flags = ExploreSegment(owner);
+		SigFlags flags = ExploreSegment(owner, seg);
 
 		if (first) {
 			first = false;
-			/* SIGSEG_FREE is set by default */
-			if (flags & SF_PBS) {
-				state = SIGSEG_PBS;
-			} else if ((flags & SF_TRAIN) || ((flags & SF_EXIT) && !(flags & SF_GREEN)) || (flags & SF_FULL)) {
-				state = SIGSEG_FULL;
-			}
+			state = GetSigSegState(flags);
 		}
 
 		/* do not do anything when some buffer was full */
@@ -544,6 +724,10 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 			break;
 		}
 
+		/* remember the layout of the block for the next time */
+		seg->pbs = (flags & SF_PBS) != 0;
+		seg->version = _signal_segment_version;
+
 		UpdateSignalsAroundSegment(flags);
 	}
 
@@ -47,6 +47,31 @@ static inline byte SignalOnTrack(Track track)
 	return _signal_on_track[track];
 }
 
+/**
+ * Can tiles of the given type be part of a signal segment?
+ * @param type The tile type to check.
+ * @return True iff trains can drive over tiles of the given type.
+ */
+static inline bool IsSignalSegmentTileType(TileType type)
+{
+	return type == MP_RAILWAY || type == MP_STATION || type == MP_ROAD || type == MP_TUNNELBRIDGE;
+}
+
+void ResetSignalSegments();
+
+/**
+ * Note that the rail network changed, so the cached signal segments
+ * have to be explored anew.
+ */
+static inline void InvalidateSignalSegments()
+{
+	extern uint32 _signal_segment_version;
+	if (++_signal_segment_version == 0) {
+		/* Wrapped; no segment may be taken for one of these versions again. */
+		ResetSignalSegments();
+	}
+}
+
 /** State of the signal segment */
 enum SigSegState {
 	SIGSEG_FREE,    ///< Free and has no pre-signal exits or at least one green exit
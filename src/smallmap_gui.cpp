@@ -582,6 +582,122 @@ static const byte _vehicle_type_colours[6] = {
 	PC_RED, PC_YELLOW, PC_LIGHT_BLUE, PC_WHITE, PC_BLACK, PC_RED
 };
 
+/**
+ * Cache of the smallmap colour of every tile at native zoom, for the map type that is currently displayed.
+ * Tiles start out stale and are computed on demand when they are drawn; afterwards only tiles that are
+ * marked dirty (see #MarkSmallMapTileDirty) are recomputed, so redrawing or scrolling the smallmap does
+ * not walk the map tiles and their (NewGRF) callbacks again.
+ */
+struct SmallMapTileCache {
+	uint32 *colours;     ///< Colour of each tile, only valid when the tile is not stale.
+	byte *importance;    ///< Importance of the effective tile type of each tile, only valid when the tile is not stale.
+	uint32 *stale;       ///< Bitmap of tiles whose cached data must be recomputed before use.
+	uint size;           ///< Number of tiles the cache has been allocated for; \c 0 when there is no cache.
+	uint sweep_pos;      ///< Next tile of the periodic sweep that marks cached tiles stale.
+
+	/**
+	 * Is the cached data of a tile stale?
+	 * @param tile Tile to check.
+	 * @return \c true if the colour and importance of \a tile must be recomputed.
+	 */
+	FORCEINLINE bool IsStale(TileIndex tile) const
+	{
+		return HasBit(this->stale[tile / 32], tile % 32);
+	}
+
+	/**
+	 * Mark a tile as stale.
+	 * @param tile Tile to mark.
+	 */
+	FORCEINLINE void MarkStale(TileIndex tile)
+	{
+		SetBit(this->stale[tile / 32], tile % 32);
+	}
+
+	/**
+	 * Store the freshly computed data of a tile.
+	 * @param tile Tile to store the data of.
+	 * @param colour Colour of the tile.
+	 * @param importance Importance of the effective tile type.
+	 */
+	FORCEINLINE void Store(TileIndex tile, uint32 colour, byte importance)
+	{
+		this->colours[tile] = colour;
+		this->importance[tile] = importance;
+		ClrBit(this->stale[tile / 32], tile % 32);
+	}
+
+	/** Make sure the cache matches the current map, and mark all tiles stale. */
+	void Allocate()
+	{
+		if (this->size != MapSize()) {
+			this->Free();
+			this->size = MapSize();
+			this->colours = MallocT<uint32>(this->size);
+			this->importance = MallocT<byte>(this->size);
+			this->stale = MallocT<uint32>(CeilDiv(this->size, 32));
+		}
+		this->Invalidate();
+	}
+
+	/** Release the cache. */
+	void Free()
+	{
+		free(this->colours);
+		free(this->importance);
+		free(this->stale);
+		this->colours = NULL;
+		this->importance = NULL;
+		this->stale = NULL;
+		this->size = 0;
+		this->sweep_pos = 0;
+	}
+
+	/** Mark all tiles stale, e.g. because the map type or the legend filters changed. */
+	void Invalidate()
+	{
+		if (this->size == 0) return;
+		memset(this->stale, 0xFF, CeilDiv(this->size, 32) * sizeof(uint32));
+	}
+
+	/**
+	 * Mark the next part of the map stale. Not every change to a tile marks it dirty
+	 * (e.g. tree growth or owner changes of a whole company), so the complete map is
+	 * periodically revalidated in small steps to bound the age of the cached data.
+	 */
+	void Sweep()
+	{
+		/* Number of sweeps it takes to mark the whole map, so the cached data is never older than this many refreshes. */
+		static const uint SWEEPS_PER_MAP = 8;
+
+		if (this->size == 0) return;
+		/* Mark a fixed part of the map, in whole bitmap words. */
+		uint words = CeilDiv(this->size, 32);
+		uint step = CeilDiv(words, SWEEPS_PER_MAP);
+		for (uint i = 0; i < step; i++) {
+			this->stale[this->sweep_pos] = 0xFFFFFFFF;
+			if (++this->sweep_pos == words) this->sweep_pos = 0;
+		}
+	}
+};
+
+static SmallMapTileCache _smallmap_cache; ///< Colour cache of the (single) smallmap window.
+
+/**
+ * Notify the smallmap that the contents of a tile changed.
+ * @param tile The changed tile.
+ */
+void MarkSmallMapTileDirty(TileIndex tile)
+{
+	if (tile < _smallmap_cache.size) _smallmap_cache.MarkStale(tile);
+}
+
+/** Notify the smallmap that the colours of all tiles must be recomputed, e.g. after a colour scheme change. */
+void InvalidateSmallMapCache()
+{
+	_smallmap_cache.Invalidate();
+}
+
 
 /** Class managing the smallmap window. */
 class SmallMapWindow : public Window {
@@ -737,6 +853,8 @@ class SmallMapWindow : public Window {
 		}
 
 		if (new_index != cur_index) {
+			/* Show the map as it is now, not as it was when the tiles were cached. */
+			_smallmap_cache.Invalidate();
 			this->zoom = zoomlevels[new_index];
 			if (cur_index >= 0) {
 				Point new_tile = this->PixelToTile(zoom_pt->x, zoom_pt->y, &sub);
@@ -749,6 +867,28 @@ class SmallMapWindow : public Window {
 		}
 	}
 
+	/**
+	 * Make sure the cached colour and importance of a tile are up to date.
+	 * @param tile Tile to update.
+	 */
+	inline void UpdateCachedTile(TileIndex tile) const
+	{
+		if (!_smallmap_cache.IsStale(tile)) return;
+
+		TileType et = GetEffectiveTileType(tile);
+		uint32 colour;
+		switch (this->map_type) {
+			case SMT_CONTOUR:    colour = GetSmallMapContoursPixels(tile, et);   break;
+			case SMT_VEHICLES:   colour = GetSmallMapVehiclesPixels(tile, et);   break;
+			case SMT_INDUSTRY:   colour = GetSmallMapIndustriesPixels(tile, et); break;
+			case SMT_ROUTES:     colour = GetSmallMapRoutesPixels(tile, et);     break;
+			case SMT_VEGETATION: colour = GetSmallMapVegetationPixels(tile, et); break;
+			case SMT_OWNER:      colour = GetSmallMapOwnerPixels(tile, et);      break;
+			default: NOT_REACHED();
+		}
+		_smallmap_cache.Store(tile, colour, _tiletype_importance[et]);
+	}
+
 	/**
 	 * Decide which colours to show to the user for a group of tiles.
 	 * @param ta Tile area to investigate.
@@ -758,38 +898,16 @@ class SmallMapWindow : public Window {
 	{
 		int importance = 0;
 		TileIndex tile = INVALID_TILE; // Position of the most important tile.
-		TileType et = MP_VOID;         // Effective tile type at that position.
 
 		TILE_AREA_LOOP(ti, ta) {
-			TileType ttype = GetEffectiveTileType(ti);
-			if (_tiletype_importance[ttype] > importance) {
-				importance = _tiletype_importance[ttype];
+			this->UpdateCachedTile(ti);
+			if (_smallmap_cache.importance[ti] > importance) {
+				importance = _smallmap_cache.importance[ti];
 				tile = ti;
-				et = ttype;
 			}
 		}
 
-		switch (this->map_type) {
-			case SMT_CONTOUR:
-				return GetSmallMapContoursPixels(tile, et);
-
-			case SMT_VEHICLES:
-				return GetSmallMapVehiclesPixels(tile, et);
-
-			case SMT_INDUSTRY:
-				return GetSmallMapIndustriesPixels(tile, et);
-
-			case SMT_ROUTES:
-				return GetSmallMapRoutesPixels(tile, et);
-
-			case SMT_VEGETATION:
-				return GetSmallMapVegetationPixels(tile, et);
-
-			case SMT_OWNER:
-				return GetSmallMapOwnerPixels(tile, et);
-
-			default: NOT_REACHED();
-		}
+		return _smallmap_cache.colours[tile];
 	}
 
 	/**
@@ -957,7 +1075,7 @@ class SmallMapWindow : public Window {
 	 * Draws the small map.
 	 *
 	 * Basically, the small map is draw column of pixels by column of pixels. The pixels
-	 * are drawn directly into the screen buffer. The final map is drawn in multiple passes.
+	 * are drawn directly into the screen buffer, taking the colours of the tiles from #_smallmap_cache. The final map is drawn in multiple passes.
 	 * The passes are:
 	 * <ol><li>The colours of tiles in the different modes.</li>
 	 * <li>Town names (optional)</li></ol>
@@ -1065,6 +1183,8 @@ public:
 
 	SmallMapWindow(const WindowDesc *desc, int window_number) : Window(), refresh(FORCE_REFRESH_PERIOD)
 	{
+		_smallmap_cache.Allocate();
+
 		this->InitNested(desc, window_number);
 		this->LowerWidget(this->map_type + SM_WIDGET_CONTOUR);
 
@@ -1079,6 +1199,11 @@ public:
 		this->SmallMapCenterOnCurrentPos();
 	}
 
+	~SmallMapWindow()
+	{
+		_smallmap_cache.Free();
+	}
+
 	/**
 	 * Compute minimal required width of the legends.
 	 * @return Minimally needed width for displaying the smallmap legends in pixels.
@@ -1264,6 +1389,7 @@ public:
 
 		this->SetupWidgetData();
 
+		_smallmap_cache.Invalidate();
 		this->SetDirty();
 	}
 
@@ -1396,6 +1522,7 @@ public:
 							}
 						}
 					}
+					_smallmap_cache.Invalidate();
 					this->SetDirty();
 				}
 				break;
@@ -1410,6 +1537,7 @@ public:
 						_legend_land_owners[i].show_on_map = true;
 					}
 				}
+				_smallmap_cache.Invalidate();
 				this->SetDirty();
 				break;
 
@@ -1423,12 +1551,14 @@ public:
 						_legend_land_owners[i].show_on_map = false;
 					}
 				}
+				_smallmap_cache.Invalidate();
 				this->SetDirty();
 				break;
 
 			case SM_WIDGET_SHOW_HEIGHT: // Enable/disable showing of heightmap.
 				_smallmap_show_heightmap = !_smallmap_show_heightmap;
 				this->SetWidgetLoweredState(SM_WIDGET_SHOW_HEIGHT, _smallmap_show_heightmap);
+				_smallmap_cache.Invalidate();
 				this->SetDirty();
 				break;
 		}
@@ -1462,6 +1592,7 @@ public:
 
 			default: NOT_REACHED();
 		}
+		_smallmap_cache.Invalidate();
 		this->SetDirty();
 	}
 
@@ -1492,6 +1623,7 @@ public:
 		if (--this->refresh != 0) return;
 
 		this->refresh = FORCE_REFRESH_PERIOD;
+		_smallmap_cache.Sweep();
 		this->SetDirty();
 	}
 
@@ -1526,6 +1658,9 @@ public:
 			sub = 0;
 		}
 
+		/* Show the map as it is now, not as it was when the tiles were cached. */
+		if (sx != this->scroll_x || sy != this->scroll_y) _smallmap_cache.Invalidate();
+
 		this->scroll_x = sx;
 		this->scroll_y = sy;
 		this->subscroll = sub;
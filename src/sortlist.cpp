@@ -0,0 +1,48 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file sortlist.cpp Helpers for sorting lists in GUIs. */
+
+#include "stdafx.h"
+#include "sortlist_type.h"
+#include "strings_func.h"
+
+/* Start at one, so fresh entries (sort 0) are never valid. */
+/* static */ uint SortNameCache::current_sort = 1;
+
+/** Free the formatted names. */
+SortNameCache::~SortNameCache()
+{
+	for (Entry *e = this->entries.Begin(); e != this->entries.End(); e++) free(e->name);
+}
+
+/**
+ * Get the name of an item, formatting it if that has not been done during this sort.
+ * @param index The index of the item; the only parameter of \a str.
+ * @param str   The string to format the name with.
+ * @return The name; valid until the name of the same item is formatted again.
+ */
+const char *SortNameCache::Get(uint index, StringID str)
+{
+	/* New entries are appended, so pointers to the names of other items stay valid. */
+	while (this->entries.Length() <= index) {
+		Entry *e = this->entries.Append();
+		e->sort = 0;
+		e->name = NULL;
+	}
+
+	Entry *e = this->entries.Get(index);
+	if (e->sort != current_sort) {
+		if (e->name == NULL) e->name = MallocT<char>(NAME_LENGTH);
+		SetDParam(0, index);
+		GetString(e->name, str, e->name + NAME_LENGTH - 1);
+		e->sort = current_sort;
+	}
+	return e->name;
+}
@@ -17,6 +17,7 @@
 #include "core/sort_func.hpp"
 #include "core/smallvec_type.hpp"
 #include "date_type.h"
+#include "strings_type.h"
 
 /** Flags of the sort list. */
 enum SortListFlags {
@@ -41,6 +42,37 @@ struct Filtering {
 	byte criteria; ///< Filtering criteria
 };
 
+/**
+ * Names of the items of a list that is sorted by name.
+ * Each name is formatted once per sort, the first time it is compared,
+ * instead of formatting both names again for every comparison.
+ */
+class SortNameCache {
+	/** The name of a single item. */
+	struct Entry {
+		uint sort; ///< The sort the name was formatted for.
+		char *name; ///< The formatted name.
+	};
+
+	SmallVector<Entry, 32> entries; ///< The names, indexed by the index of the item.
+
+	static uint current_sort; ///< Number of the sort that is currently done.
+
+public:
+	/** The length of a name, including the terminating '\0'. */
+	static const uint NAME_LENGTH = 96;
+
+	~SortNameCache();
+
+	const char *Get(uint index, StringID str);
+
+	/** Start a new sort; all names have to be formatted again. */
+	static void NewSort()
+	{
+		current_sort++;
+	}
+};
+
 /**
  * List template of 'things' \p T to sort in a GUI.
  * @tparam T Type of data stored in the list to represent each item.
@@ -247,7 +279,7 @@ public:
 	 * Sort the list.
 	 *  For the first sorting we use quick sort since it is
 	 *  faster for irregular sorted data. After that we
-	 *  use gsort.
+	 *  use merge sort, which is fast for presorted data.
 	 *
 	 * @param compare The function to compare two list items
 	 * @return true if the list sequence has been altered
@@ -267,6 +299,8 @@ public:
 
 		const bool desc = (this->flags & VL_DESC) != 0;
 
+		SortNameCache::NewSort();
+
 		if (this->flags & VL_FIRST_SORT) {
 			CLRBITS(this->flags, VL_FIRST_SORT);
 
@@ -274,7 +308,7 @@ public:
 			return true;
 		}
 
-		GSortT(this->data, this->items, compare, desc);
+		MSortT(this->data, this->items, compare, desc);
 		return true;
 	}
 
@@ -16,6 +16,7 @@
 #include "fios.h"
 #include "window_gui.h"
 #include "vehicle_base.h"
+#include "core/smallvec_type.hpp"
 
 /* The type of set we're replacing */
 #define SET_TYPE "sounds"
@@ -164,14 +165,16 @@ static void StartSound(SoundID sound_id, float pan, uint volume)
 	/* Empty sound? */
 	if (sound->rate == 0) return;
 
-	MixerChannel *mc = MxAllocateChannel();
+	/* Apply the sound effect's own volume. */
+	volume = sound->volume * volume;
+
+	/* When too many sounds are playing, the quietest and least important
+	 * ones are dropped; do so before reading the sound data. */
+	MixerChannel *mc = MxAllocateChannel(sound->priority << 16 | volume);
 	if (mc == NULL) return;
 
 	if (!SetBankSource(mc, sound)) return;
 
-	/* Apply the sound effect's own volume. */
-	volume = sound->volume * volume;
-
 	MxSetChannelVolume(mc, volume, pan);
 	MxActivateChannel(mc);
 }
@@ -249,6 +252,67 @@ static void SndPlayScreenCoordFx(SoundID sound, int left, int right, int top, in
 	}
 }
 
+static SmallVector<Rect, 4> _sound_viewport_areas; ///< Areas, in virtual coordinates, shown by viewports when vehicle sounds were last triggered.
+static uint _vehicle_sounds_checked = 0; ///< Number of times vehicles were checked for being audible.
+static uint _vehicle_sounds_culled = 0;  ///< Number of times vehicles were found to be inaudible.
+
+/**
+ * Remember the areas shown by viewports, so vehicle sounds elsewhere can
+ * be skipped before their NewGRF callbacks are resolved.
+ * Must be called before vehicles trigger their sounds for a tick.
+ */
+void UpdateSoundViewportAreas()
+{
+	_sound_viewport_areas.Clear();
+
+	/* Without sound effects nothing can be heard anywhere. */
+	if (_settings_client.music.effect_vol == 0) return;
+
+	const Window *w;
+	FOR_ALL_WINDOWS_FROM_BACK(w) {
+		const ViewPort *vp = w->viewport;
+		if (vp == NULL) continue;
+
+		Rect *r = _sound_viewport_areas.Append();
+		r->left   = vp->virtual_left;
+		r->top    = vp->virtual_top;
+		r->right  = vp->virtual_left + vp->virtual_width;
+		r->bottom = vp->virtual_top + vp->virtual_height;
+	}
+}
+
+/**
+ * Check whether the sounds of a vehicle can be heard, i.e. whether any viewport shows it.
+ * This uses the same test as #SndPlayScreenCoordFx, on the areas of #UpdateSoundViewportAreas.
+ * @param v The vehicle to check.
+ * @return True when the vehicle is shown by a viewport.
+ */
+bool IsVehicleAudible(const Vehicle *v)
+{
+	_vehicle_sounds_checked++;
+
+	for (const Rect *r = _sound_viewport_areas.Begin(); r != _sound_viewport_areas.End(); r++) {
+		if (v->coord.left < r->right && v->coord.right > r->left &&
+				v->coord.top < r->bottom && v->coord.bottom > r->top) {
+			return true;
+		}
+	}
+
+	_vehicle_sounds_culled++;
+	return false;
+}
+
+/**
+ * Get the statistics of skipping the sounds of vehicles no viewport shows.
+ * @param checked Place to store the number of checked vehicles.
+ * @param culled  Place to store the number of vehicles whose sounds were skipped.
+ */
+void GetVehicleSoundCullStats(uint *checked, uint *culled)
+{
+	*checked = _vehicle_sounds_checked;
+	*culled = _vehicle_sounds_culled;
+}
+
 void SndPlayTileFx(SoundID sound, TileIndex tile)
 {
 	/* emits sound from center of the tile */
@@ -21,4 +21,8 @@ void SndPlayVehicleFx(SoundID sound, const Vehicle *v);
 void SndPlayFx(SoundID sound);
 void SndCopyToPool();
 
+void UpdateSoundViewportAreas();
+bool IsVehicleAudible(const Vehicle *v);
+void GetVehicleSoundCullStats(uint *checked, uint *culled);
+
 #endif /* SOUND_FUNC_H */
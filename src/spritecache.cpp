@@ -607,6 +607,39 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 	}
 }
 
+/** Buffer that receives the sprites read by #ReadAllSprites. */
+static ReusableBuffer<byte> _read_all_sprites_buffer;
+
+/**
+ * Allocator for #ReadAllSprites that keeps reusing the same buffer.
+ * @param size Number of bytes to allocate.
+ * @return The buffer.
+ */
+static void *ReadAllSpritesAllocator(size_t size)
+{
+	return _read_all_sprites_buffer.Allocate(size);
+}
+
+/**
+ * Read (and decode) every sprite from disk, bypassing the sprite cache.
+ * This gives the cost of filling the sprite cache from a cold start.
+ * @return Number of read sprites.
+ */
+uint ReadAllSprites()
+{
+	uint count = 0;
+	for (SpriteID sprite = 0; sprite < _spritecache_items; sprite++) {
+		if (!SpriteExists(sprite)) continue;
+
+		SpriteType type = GetSpriteCache(sprite)->type;
+		if (type == ST_INVALID) continue;
+
+		GetRawSprite(sprite, type, ReadAllSpritesAllocator);
+		count++;
+	}
+	return count;
+}
+
 
 void GfxInitSpriteMem()
 {
@@ -53,5 +53,6 @@ void IncreaseSpriteLRU();
 bool LoadNextSprite(int load_index, byte file_index, uint file_sprite_id);
 bool SkipSpriteData(byte type, uint16 num);
 void DupSprite(SpriteID old_spr, SpriteID new_spr);
+uint ReadAllSprites();
 
 #endif /* SPRITECACHE_H */
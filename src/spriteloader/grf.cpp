@@ -41,6 +41,114 @@ static bool WarnCorruptSprite(uint8 file_slot, size_t file_pos, int line)
 	return false;
 }
 
+/** Reader of (compressed) sprite data through the buffered Fio functions. */
+struct FioSpriteDataReader {
+	/**
+	 * Read the next byte.
+	 * @return The read byte, or \c 0 at the end of the file.
+	 */
+	FORCEINLINE byte ReadByte()
+	{
+		return FioReadByte();
+	}
+
+	/**
+	 * Read a block of bytes.
+	 * @param dest Destination of the data.
+	 * @param size Number of bytes to read.
+	 */
+	FORCEINLINE void ReadBlock(byte *dest, int size)
+	{
+		for (; size > 0; size--) *dest++ = FioReadByte();
+	}
+};
+
+/** Reader of (compressed) sprite data directly from the memory mapping of a file. */
+class MappedSpriteDataReader {
+	const byte *start; ///< Start of the data.
+	const byte *pos;   ///< Current read position.
+	const byte *end;   ///< End of the mapped file.
+
+public:
+	/**
+	 * Create a reader for mapped data.
+	 * @param data Data at the current position in the file.
+	 * @param size Number of bytes until the end of the file.
+	 */
+	MappedSpriteDataReader(const byte *data, size_t size) : start(data), pos(data), end(data + size) {}
+
+	/**
+	 * Read the next byte.
+	 * @return The read byte, or \c 0 at the end of the file.
+	 */
+	FORCEINLINE byte ReadByte()
+	{
+		return this->pos < this->end ? *this->pos++ : 0;
+	}
+
+	/**
+	 * Read a block of bytes.
+	 * @param dest Destination of the data.
+	 * @param size Number of bytes to read.
+	 */
+	FORCEINLINE void ReadBlock(byte *dest, int size)
+	{
+		int available = (int)min<size_t>(size, this->end - this->pos);
+		memcpy(dest, this->pos, available);
+		memset(dest + available, 0, size - available);
+		this->pos += available;
+	}
+
+	/**
+	 * Get the number of bytes read so far.
+	 * @return Number of consumed bytes.
+	 */
+	size_t GetConsumed() const
+	{
+		return this->pos - this->start;
+	}
+};
+
+/**
+ * Decompress the data of a sprite.
+ * @param reader Source of the compressed data.
+ * @param dest_orig Destination of the decompressed data.
+ * @param num Number of bytes to decompress.
+ * @return \c 0 on success, otherwise the line where the corruption of the sprite was detected.
+ */
+template <class Treader>
+static int DecompressSpriteData(Treader &reader, byte *dest_orig, int num)
+{
+	byte *dest = dest_orig;
+
+	while (num > 0) {
+		int8 code = reader.ReadByte();
+
+		if (code >= 0) {
+			/* Plain bytes to read */
+			int size = (code == 0) ? 0x80 : code;
+			num -= size;
+			if (num < 0) return __LINE__;
+			reader.ReadBlock(dest, size);
+			dest += size;
+		} else {
+			/* Copy bytes from earlier in the sprite */
+			const uint data_offset = ((code & 7) << 8) | reader.ReadByte();
+			if (dest - data_offset < dest_orig) return __LINE__;
+			int size = -(code >> 3);
+			num -= size;
+			if (num < 0) return __LINE__;
+			for (; size > 0; size--) {
+				*dest = *(dest - data_offset);
+				dest++;
+			}
+		}
+	}
+
+	if (num != 0) return __LINE__;
+	return 0;
+}
+
 bool SpriteLoaderGrf::LoadSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type)
 {
 	/* Open the right file and go to the correct position */
@@ -66,34 +174,20 @@ bool SpriteLoaderGrf::LoadSprite(SpriteLoader::Sprite *sprite, uint8 file_slot,
 	byte *dest = dest_orig;
 	const int dest_size = num;
 
-	/* Read the file, which has some kind of compression */
-	while (num > 0) {
-		int8 code = FioReadByte();
-
-		if (code >= 0) {
-			/* Plain bytes to read */
-			int size = (code == 0) ? 0x80 : code;
-			num -= size;
-			if (num < 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
-			for (; size > 0; size--) {
-				*dest = FioReadByte();
-				dest++;
-			}
-		} else {
-			/* Copy bytes from earlier in the sprite */
-			const uint data_offset = ((code & 7) << 8) | FioReadByte();
-			if (dest - data_offset < dest_orig) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
-			int size = -(code >> 3);
-			num -= size;
-			if (num < 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
-			for (; size > 0; size--) {
-				*dest = *(dest - data_offset);
-				dest++;
-			}
-		}
+	/* Read the file, which has some kind of compression. When the file is
+	 * memory mapped, decompress straight from the mapping. */
+	int error_line;
+	size_t mapped_size;
+	const byte *mapped = FioGetMappedData(&mapped_size);
+	if (mapped != NULL) {
+		MappedSpriteDataReader reader(mapped, mapped_size);
+		error_line = DecompressSpriteData(reader, dest_orig, num);
+		FioSkipBytes(reader.GetConsumed());
+	} else {
+		FioSpriteDataReader reader;
+		error_line = DecompressSpriteData(reader, dest_orig, num);
 	}
-
-	if (num != 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+	if (error_line != 0) return WarnCorruptSprite(file_slot, file_pos, error_line);
 
 	sprite->AllocateData(sprite->width * sprite->height);
 
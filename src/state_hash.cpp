@@ -0,0 +1,262 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file state_hash.cpp Hashes of parts of the game state, to find out where a desync started.
+ *
+ * Only state that is saved is hashed; caches are rebuilt by clients when
+ * they join, so they may differ without the game being out of sync.
+ */
+
+#include "stdafx.h"
+#include "debug.h"
+#include "date_func.h"
+#include "map_func.h"
+#include "vehicle_base.h"
+#include "vehicle_func.h"
+#include "station_base.h"
+#include "company_base.h"
+#include "cargopacket.h"
+#include "state_hash.h"
+
+/** The map is hashed in this many slices; one slice per frame that is hashed. */
+static const uint STATE_HASH_TILE_SLICES = 64;
+
+/** Hash of a number of values (32 bits FNV-1a, on whole values instead of bytes). */
+struct StateHasher {
+	uint32 hash; ///< The hash so far.
+
+	/** Start an empty hash. */
+	StateHasher() : hash(2166136261U) {}
+
+	/**
+	 * Add a value to the hash.
+	 * @param value The value to add.
+	 */
+	FORCEINLINE void Add(uint32 value)
+	{
+		this->hash = (this->hash ^ value) * 16777619U;
+	}
+
+	/**
+	 * Add a 64 bits value to the hash.
+	 * @param value The value to add.
+	 */
+	FORCEINLINE void Add64(uint64 value)
+	{
+		this->Add((uint32)value);
+		this->Add((uint32)(value >> 32));
+	}
+};
+
+/**
+ * Add the hash of a single object to the hash of a part of the game state,
+ * and log it if asked to.
+ * @param total  The hash of the part of the game state.
+ * @param type   The part of the game state.
+ * @param index  The index of the object.
+ * @param object The hash of the object.
+ * @param log    Whether to write the hash of the object to the desync log.
+ */
+static void AddObjectHash(StateHasher &total, StateHashType type, uint index, const StateHasher &object, bool log)
+{
+	total.Add(index);
+	total.Add(object.hash);
+	if (log) DEBUG(desync, 1, "hash: %08x; %02x; %s %u %08x", _date, _date_fract, GetStateHashName(type), index, object.hash);
+}
+
+/**
+ * Hash one slice of the map; every row of tiles is an object.
+ * The slice depends on the frame, so the whole map gets checked over time.
+ * @param frame The frame the hash is made for.
+ * @param log   Whether to log the hash of every object.
+ * @return The hash.
+ */
+static uint32 HashTiles(uint32 frame, bool log)
+{
+	/* Scatter the slices, as the frames that are hashed are usually a fixed distance apart. */
+	uint slice = (frame * 2654435761U) >> 26;
+	assert_compile(STATE_HASH_TILE_SLICES == 1 << (32 - 26));
+
+	uint rows = max(1U, MapSizeY() / STATE_HASH_TILE_SLICES);
+	uint first = slice * rows;
+
+	StateHasher total;
+	for (uint y = first; y < first + rows && y < MapSizeY(); y++) {
+		StateHasher row;
+		for (TileIndex t = TileXY(0, y); t <= TileXY(MapMaxX(), y); t++) {
+			const Tile &m = _m[t];
+			row.Add(m.type_height | m.m1 << 8 | m.m2 << 16);
+			row.Add(m.m3 | m.m4 << 8 | m.m5 << 16 | m.m6 << 24);
+			row.Add(_me[t].m7);
+		}
+		AddObjectHash(total, SHT_TILES, y, row, log);
+	}
+	return total.hash;
+}
+
+/**
+ * Hash the vehicles of the companies.
+ * @param log Whether to log the hash of every object.
+ * @return The hash.
+ */
+static uint32 HashVehicles(bool log)
+{
+	StateHasher total;
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		if (!IsCompanyBuildableVehicleType(v)) continue;
+
+		StateHasher h;
+		h.Add(v->type | v->subtype << 8 | v->owner << 16 | v->direction << 24);
+		h.Add(v->tile);
+		h.Add(v->x_pos);
+		h.Add(v->y_pos);
+		h.Add(v->z_pos);
+		h.Add(v->cur_speed | v->subspeed << 16 | v->progress << 24);
+		h.Add(v->vehstatus | v->breakdown_ctr << 8 | v->breakdown_delay << 16 | v->breakdowns_since_last_service << 24);
+		h.Add(v->reliability);
+		h.Add(v->age);
+		h.Add(v->cargo_type | v->cargo_cap << 8);
+		h.Add(v->current_order.GetType() | v->current_order.GetDestination() << 8);
+		h.Add(v->cur_implicit_order_index | v->cur_real_order_index << 8);
+		h.Add64(v->profit_this_year);
+		h.Add64(v->value);
+		AddObjectHash(total, SHT_VEHICLES, v->index, h, log);
+	}
+	return total.hash;
+}
+
+/**
+ * Hash the stations and waypoints.
+ * @param log Whether to log the hash of every object.
+ * @return The hash.
+ */
+static uint32 HashStations(bool log)
+{
+	StateHasher total;
+	const BaseStation *bst;
+	FOR_ALL_BASE_STATIONS(bst) {
+		StateHasher h;
+		h.Add(bst->xy);
+		h.Add(bst->owner | bst->facilities << 8 | bst->delete_ctr << 16);
+		h.Add(bst->build_date);
+		h.Add(bst->random_bits);
+
+		if (Station::IsExpected(bst)) {
+			const Station *st = Station::From(bst);
+			for (CargoID c = 0; c < NUM_CARGO; c++) {
+				const GoodsEntry &ge = st->goods[c];
+				h.Add(ge.acceptance_pickup | ge.days_since_pickup << 8 | ge.rating << 16 | ge.amount_fract << 24);
+			}
+			h.Add(st->time_since_load | st->time_since_unload << 8);
+		}
+		AddObjectHash(total, SHT_STATIONS, bst->index, h, log);
+	}
+	return total.hash;
+}
+
+/**
+ * Hash the finances and shares of the companies.
+ * @param log Whether to log the hash of every object.
+ * @return The hash.
+ */
+static uint32 HashCompanies(bool log)
+{
+	StateHasher total;
+	const Company *c;
+	FOR_ALL_COMPANIES(c) {
+		StateHasher h;
+		h.Add64(c->money);
+		h.Add64(c->current_loan);
+		h.Add(c->share_owners[0] | c->share_owners[1] << 8 | c->share_owners[2] << 16 | c->share_owners[3] << 24);
+		h.Add(c->quarters_of_bankruptcy | c->bankrupt_asked << 8);
+		h.Add64(c->cur_economy.income);
+		h.Add64(c->cur_economy.expenses);
+		AddObjectHash(total, SHT_COMPANIES, c->index, h, log);
+	}
+	return total.hash;
+}
+
+/**
+ * Hash the cargo packets.
+ * @param log Whether to log the hash of every object.
+ * @return The hash.
+ */
+static uint32 HashCargo(bool log)
+{
+	StateHasher total;
+	const CargoPacket *cp;
+	FOR_ALL_CARGOPACKETS(cp) {
+		StateHasher h;
+		h.Add(cp->Count() | cp->DaysInTransit() << 16 | cp->SourceSubsidyType() << 24);
+		h.Add(cp->SourceSubsidyID() | cp->SourceStation() << 16);
+		h.Add(cp->SourceStationXY());
+		h.Add(cp->LoadedAtXY());
+		h.Add64(cp->FeederShare());
+		AddObjectHash(total, SHT_CARGO, cp->index, h, log);
+	}
+	return total.hash;
+}
+
+/**
+ * Hash a part of the game state.
+ * @param type  The part to hash.
+ * @param frame The frame the hash is made for.
+ * @param log   Whether to log the hash of every object.
+ * @return The hash.
+ */
+static uint32 HashState(StateHashType type, uint32 frame, bool log)
+{
+	switch (type) {
+		case SHT_TILES:     return HashTiles(frame, log);
+		case SHT_VEHICLES:  return HashVehicles(log);
+		case SHT_STATIONS:  return HashStations(log);
+		case SHT_COMPANIES: return HashCompanies(log);
+		case SHT_CARGO:     return HashCargo(log);
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Hash all parts of the game state. Only a slice of the map is hashed,
+ * so this is cheap enough to do at every sync check.
+ * @param[out] hashes The hashes.
+ * @param frame       The frame the hashes are made for.
+ */
+void CalculateStateHashes(StateHashes *hashes, uint32 frame)
+{
+	for (StateHashType type = SHT_BEGIN; type < SHT_END; type++) {
+		hashes->hash[type] = HashState(type, frame, false);
+	}
+}
+
+/**
+ * Write the hash of every object of a part of the game state to the desync
+ * log. Comparing the logs of a server and a client shows which object differs.
+ * @param type  The part of the game state.
+ * @param frame The frame the hashes are made for.
+ */
+void LogStateHash(StateHashType type, uint32 frame)
+{
+	HashState(type, frame, true);
+}
+
+/**
+ * Get the name of a part of the game state.
+ * @param type The part of the game state.
+ * @return The name.
+ */
+const char *GetStateHashName(StateHashType type)
+{
+	static const char * const names[] = {"tiles", "vehicles", "stations", "companies", "cargo"};
+	assert_compile(lengthof(names) == SHT_END);
+	assert(type < SHT_END);
+	return names[type];
+}
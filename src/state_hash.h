@@ -0,0 +1,38 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file state_hash.h Hashes of parts of the game state, to find out where a desync started. */
+
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include "core/enum_type.hpp"
+
+/** The parts of the game state that are hashed separately. */
+enum StateHashType {
+	SHT_BEGIN = 0,
+	SHT_TILES = 0, ///< A slice of the map.
+	SHT_VEHICLES,  ///< The vehicles of the companies.
+	SHT_STATIONS,  ///< Stations and waypoints.
+	SHT_COMPANIES, ///< The finances and shares of the companies.
+	SHT_CARGO,     ///< The cargo packets.
+	SHT_END,
+};
+DECLARE_POSTFIX_INCREMENT(StateHashType)
+
+/** The hashes of the game state at a single frame. */
+struct StateHashes {
+	uint32 hash[SHT_END]; ///< The hash of each part of the game state.
+};
+
+void CalculateStateHashes(StateHashes *hashes, uint32 frame);
+void LogStateHash(StateHashType type, uint32 frame);
+const char *GetStateHashName(StateHashType type);
+
+#endif /* STATE_HASH_H */
@@ -170,6 +170,18 @@ struct Airport : public TileArea {
 
 typedef SmallVector<Industry *, 2> IndustryVector;
 
+/**
+ * Acceptance of the tiles around a station, as far as it does not change
+ * without the tiles changing, i.e. without NewGRF callbacks.
+ */
+struct StationAcceptanceCache {
+	TileArea area;                           ///< The tiles the cache covers.
+	uint32 version;                          ///< The acceptance version when the cache was filled; 0 when it was never filled.
+	CargoArray acceptance;                   ///< Acceptance of the tiles whose acceptance is cached.
+	uint32 always_accepted;                  ///< Always accepted cargo types of the tiles whose acceptance is cached.
+	SmallVector<TileIndex, 8> dynamic_tiles; ///< Tiles whose acceptance has to be determined anew every time.
+};
+
 /** Station data structure */
 struct Station : SpecializedStation<Station, false> {
 public:
@@ -201,6 +213,7 @@ public:
 	uint32 always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
 
 	IndustryVector industries_near; ///< Cached list of industries near the station that can accept cargo, @see DeliverGoodsToIndustry()
+	StationAcceptanceCache acceptance_cache; ///< NOSAVE: Cached acceptance of the tiles around the station, @see UpdateStationAcceptance()
 
 	Station(TileIndex tile = INVALID_TILE);
 	~Station();
@@ -48,6 +48,8 @@
 #include "table/airporttile_ids.h"
 #include "newgrf_airporttiles.h"
 #include "order_backup.h"
+#include "newgrf_house.h"
+#include "object_map.h"
 
 #include "table/strings.h"
 
@@ -518,18 +520,15 @@ CargoArray GetProductionAroundTiles(TileIndex tile, int w, int h, int rad)
 }
 
 /**
- * Get the acceptance of cargos around the tile in 1/8.
- * @param tile Center of the search area
- * @param w X extent of area
- * @param h Y extent of area
- * @param rad Search radius in addition to given area
- * @param always_accepted bitmask of cargo accepted by houses and headquarters; can be NULL
+ * Get the tiles around an area that count for acceptance.
+ * @param tile North tile of the area
+ * @param w X extent of the area
+ * @param h Y extent of the area
+ * @param rad Search radius in addition to the given area
+ * @return The area including the search radius, limited to the map.
  */
-CargoArray GetAcceptanceAroundTiles(TileIndex tile, int w, int h, int rad, uint32 *always_accepted)
+static TileArea GetAcceptanceArea(TileIndex tile, int w, int h, int rad)
 {
-	CargoArray acceptance;
-	if (always_accepted != NULL) *always_accepted = 0;
-
 	int x = TileX(tile);
 	int y = TileY(tile);
 
@@ -545,13 +544,147 @@ CargoArray GetAcceptanceAroundTiles(TileIndex tile, int w, int h, int rad, uint3
 	assert(w > 0);
 	assert(h > 0);
 
-	for (int yc = y1; yc != y2; yc++) {
-		for (int xc = x1; xc != x2; xc++) {
-			TileIndex tile = TileXY(xc, yc);
-			AddAcceptedCargo(tile, acceptance, always_accepted);
+	return TileArea(TileXY(x1, y1), TileXY(x2 - 1, y2 - 1));
+}
+
+/**
+ * Get the acceptance of cargos around the tile in 1/8.
+ * @param tile Center of the search area
+ * @param w X extent of area
+ * @param h Y extent of area
+ * @param rad Search radius in addition to given area
+ * @param always_accepted bitmask of cargo accepted by houses and headquarters; can be NULL
+ */
+CargoArray GetAcceptanceAroundTiles(TileIndex tile, int w, int h, int rad, uint32 *always_accepted)
+{
+	CargoArray acceptance;
+	if (always_accepted != NULL) *always_accepted = 0;
+
+	TileArea ta = GetAcceptanceArea(tile, w, h, rad);
+	TILE_AREA_LOOP(tile, ta) AddAcceptedCargo(tile, acceptance, always_accepted);
+
+	return acceptance;
+}
+
+/** Number of bits of the tile coordinates that are dropped to get the block whose changes are tracked. */
+static const uint ACCEPTANCE_BLOCK_BITS = 4;
+
+static uint32 *_acceptance_block_versions = NULL; ///< For each block of the map, the acceptance version of its last change.
+static uint32 _acceptance_version = 1;            ///< The acceptance version; increased whenever a block of the map changes.
+
+/**
+ * Get the index of the block of a tile.
+ * @param x X coordinate of the tile.
+ * @param y Y coordinate of the tile.
+ * @return The index in #_acceptance_block_versions.
+ */
+static FORCEINLINE uint GetAcceptanceBlockIndex(uint x, uint y)
+{
+	return (y >> ACCEPTANCE_BLOCK_BITS) * (MapSizeX() >> ACCEPTANCE_BLOCK_BITS) + (x >> ACCEPTANCE_BLOCK_BITS);
+}
+
+/** Forget about all changes of the map; to be called when the map is (re)allocated. */
+void InitializeStationAcceptanceCaches()
+{
+	free(_acceptance_block_versions);
+	_acceptance_block_versions = CallocT<uint32>(MapSize() >> (2 * ACCEPTANCE_BLOCK_BITS));
+}
+
+/**
+ * Note that a tile changed in a way that might change its acceptance,
+ * so the stations around it need to look at it again.
+ * @param tile The changed tile.
+ */
+void InvalidateStationAcceptance(TileIndex tile)
+{
+	if (_acceptance_block_versions == NULL) return;
+
+	_acceptance_block_versions[GetAcceptanceBlockIndex(TileX(tile), TileY(tile))] = ++_acceptance_version;
+}
+
+/** Note that the acceptance of any tile might have changed, e.g. because the NewGRFs changed. */
+void InvalidateAllStationAcceptance()
+{
+	if (_acceptance_block_versions == NULL) return;
+
+	_acceptance_version++;
+	uint blocks = MapSize() >> (2 * ACCEPTANCE_BLOCK_BITS);
+	for (uint i = 0; i < blocks; i++) _acceptance_block_versions[i] = _acceptance_version;
+}
+
+/**
+ * Check whether the acceptance of a tile has to be determined anew every
+ * time, as it can change without the tile changing.
+ * @param tile The tile to check.
+ * @return True when the acceptance of the tile may not be cached.
+ */
+static bool HasDynamicAcceptance(TileIndex tile)
+{
+	switch (GetTileType(tile)) {
+		case MP_HOUSE: {
+			const HouseSpec *hs = HouseSpec::Get(GetHouseType(tile));
+			return HasBit(hs->callback_mask, CBM_HOUSE_ACCEPT_CARGO) || HasBit(hs->callback_mask, CBM_HOUSE_CARGO_ACCEPTANCE);
+		}
+
+		/* The graphics of industry tiles change all the time, e.g. when animating. */
+		case MP_INDUSTRY: return true;
+
+		/* The headquarters grow with the company. */
+		case MP_OBJECT: return IsCompanyHQ(tile);
+
+		default: return false;
+	}
+}
+
+/**
+ * Get the acceptance of the tiles around a station, using and maintaining its cache.
+ * @param st The station.
+ * @param ta The tiles around the station.
+ * @param always_accepted Place to store the always accepted cargo types.
+ * @return The acceptance, the same as #GetAcceptanceAroundTiles would give.
+ */
+static CargoArray GetStationAcceptance(Station *st, const TileArea &ta, uint32 *always_accepted)
+{
+	StationAcceptanceCache *cache = &st->acceptance_cache;
+
+	bool valid = cache->version != 0 && cache->area.tile == ta.tile && cache->area.w == ta.w && cache->area.h == ta.h;
+	if (valid) {
+		/* Did anything change since the cache was filled? */
+		uint bx1 = TileX(ta.tile) >> ACCEPTANCE_BLOCK_BITS;
+		uint by1 = TileY(ta.tile) >> ACCEPTANCE_BLOCK_BITS;
+		uint bx2 = (TileX(ta.tile) + ta.w - 1) >> ACCEPTANCE_BLOCK_BITS;
+		uint by2 = (TileY(ta.tile) + ta.h - 1) >> ACCEPTANCE_BLOCK_BITS;
+		for (uint by = by1; valid && by <= by2; by++) {
+			for (uint bx = bx1; bx <= bx2; bx++) {
+				if (_acceptance_block_versions[by * (MapSizeX() >> ACCEPTANCE_BLOCK_BITS) + bx] > cache->version) {
+					valid = false;
+					break;
+				}
+			}
 		}
 	}
 
+	if (!valid) {
+		cache->area = ta;
+		cache->version = _acceptance_version;
+		cache->acceptance.Clear();
+		cache->always_accepted = 0;
+		cache->dynamic_tiles.Clear();
+
+		TILE_AREA_LOOP(tile, ta) {
+			if (HasDynamicAcceptance(tile)) {
+				*cache->dynamic_tiles.Append() = tile;
+			} else {
+				AddAcceptedCargo(tile, cache->acceptance, &cache->always_accepted);
+			}
+		}
+	}
+
+	CargoArray acceptance = cache->acceptance;
+	*always_accepted = cache->always_accepted;
+	for (const TileIndex *tile = cache->dynamic_tiles.Begin(); tile != cache->dynamic_tiles.End(); tile++) {
+		AddAcceptedCargo(*tile, acceptance, always_accepted);
+	}
 	return acceptance;
 }
 
@@ -568,13 +701,13 @@ void UpdateStationAcceptance(Station *st, bool show_msg)
 	/* And retrieve the acceptance. */
 	CargoArray acceptance;
 	if (!st->rect.IsEmpty()) {
-		acceptance = GetAcceptanceAroundTiles(
+		TileArea ta = GetAcceptanceArea(
 			TileXY(st->rect.left, st->rect.top),
 			st->rect.right  - st->rect.left + 1,
 			st->rect.bottom - st->rect.top  + 1,
-			st->GetCatchmentRadius(),
-			&st->always_accepted
+			st->GetCatchmentRadius()
 		);
+		acceptance = GetStationAcceptance(st, ta, &st->always_accepted);
 	}
 
 	/* Adjust in case our station only accepts fewer kinds of goods */
@@ -210,7 +210,6 @@ protected:
 	static bool include_empty;            // whether we should include stations without waiting cargo
 	static const uint32 cargo_filter_max;
 	static uint32 cargo_filter;           // bitmap of cargo types to include
-	static const Station *last_station;
 
 	/* Constants for sorting stations */
 	static const StringID sorter_names[];
@@ -263,19 +262,10 @@ protected:
 	/** Sort stations by their name */
 	static int CDECL StationNameSorter(const Station * const *a, const Station * const *b)
 	{
-		static char buf_cache[64];
-		char buf[64];
+		/* Cached names, to spare many GetString() calls. */
+		static SortNameCache names;
 
-		SetDParam(0, (*a)->index);
-		GetString(buf, STR_STATION_NAME, lastof(buf));
-
-		if (*b != last_station) {
-			last_station = *b;
-			SetDParam(0, (*b)->index);
-			GetString(buf_cache, STR_STATION_NAME, lastof(buf_cache));
-		}
-
-		return strcmp(buf, buf_cache);
+		return strcmp(names.Get((*a)->index, STR_STATION_NAME), names.Get((*b)->index, STR_STATION_NAME));
 	}
 
 	/** Sort stations by their type */
@@ -333,9 +323,6 @@ protected:
 	{
 		if (!this->stations.Sort()) return;
 
-		/* Reset name sorter sort cache */
-		this->last_station = NULL;
-
 		/* Set the modified widget dirty */
 		this->SetWidgetDirty(SLW_LIST);
 	}
@@ -708,7 +695,6 @@ byte CompanyStationsWindow::facilities = FACIL_TRAIN | FACIL_TRUCK_STOP | FACIL_
 bool CompanyStationsWindow::include_empty = true;
 const uint32 CompanyStationsWindow::cargo_filter_max = UINT32_MAX;
 uint32 CompanyStationsWindow::cargo_filter = UINT32_MAX;
-const Station *CompanyStationsWindow::last_station = NULL;
 
 /* Availible station sorting functions */
 GUIStationList::SortFunction * const CompanyStationsWindow::sorter_funcs[] = {
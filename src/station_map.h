@@ -81,6 +81,7 @@ static inline StationGfx GetStationGfx(TileIndex t)
 static inline void SetStationGfx(TileIndex t, StationGfx gfx)
 {
 	assert(IsTileType(t, MP_STATION));
+	InvalidateSignalSegments();
 	_m[t].m5 = gfx;
 }
 
@@ -482,6 +483,7 @@ static inline bool IsCustomStationSpecIndex(TileIndex t)
 static inline void SetCustomStationSpecIndex(TileIndex t, byte specindex)
 {
 	assert(HasStationTileRail(t));
+	InvalidateSignalSegments();
 	_m[t].m4 = specindex;
 }
 
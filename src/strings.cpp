@@ -112,6 +112,79 @@ static uint _langtab_num[32];   ///< Offset into langpack offs
 static uint _langtab_start[32]; ///< Offset into langpack offs
 static bool _keep_gender_data = false;  ///< Should we retain the gender data in the current string?
 
+/** Kinds of objects whose default names are cached. */
+enum NameCacheType {
+	NCT_TOWN,     ///< Names of towns.
+	NCT_STATION,  ///< Names of stations.
+	NCT_WAYPOINT, ///< Names of waypoints and buoys.
+	NCT_END,      ///< End marker.
+};
+
+/**
+ * The formatted default name of an object. Names of towns and stations are
+ * asked for all the time by lists, sorters and signs, while they hardly ever
+ * change, so they are only formatted once.
+ */
+struct CachedName {
+	uint64 key;     ///< The properties of the object the name was formatted from.
+	char *name;     ///< The name, or NULL when nothing has been cached yet.
+};
+
+static SmallVector<CachedName, 64> _name_cache[NCT_END]; ///< The cached names, by object index.
+
+/**
+ * Forget all cached names of objects. Needed when something changes
+ * that default names are made of, like the language or a town's name.
+ */
+void InvalidateNameCache()
+{
+	for (uint type = 0; type != NCT_END; type++) {
+		for (CachedName *cn = _name_cache[type].Begin(); cn != _name_cache[type].End(); cn++) free(cn->name);
+		_name_cache[type].Clear();
+	}
+}
+
+/**
+ * Get the cached name of an object. Names formatted with gender data
+ * are never cached, so the cache must not be used when gender data is kept.
+ * @param type  The kind of object.
+ * @param index The index of the object.
+ * @param key   The properties of the object the name depends on.
+ * @return The name, or NULL when there is no valid name cached.
+ */
+static const char *GetCachedName(NameCacheType type, uint index, uint64 key)
+{
+	if (index >= _name_cache[type].Length()) return NULL;
+
+	const CachedName *cn = _name_cache[type].Get(index);
+	if (cn->name == NULL || cn->key != key) return NULL;
+	return cn->name;
+}
+
+/**
+ * Cache the name of an object.
+ * @param type  The kind of object.
+ * @param index The index of the object.
+ * @param key   The properties of the object the name depends on.
+ * @param name  The formatted name.
+ * @return The cached copy of the name.
+ */
+static const char *SetCachedName(NameCacheType type, uint index, uint64 key, const char *name)
+{
+	SmallVector<CachedName, 64> &cache = _name_cache[type];
+	if (index >= cache.Length()) {
+		uint old_length = cache.Length();
+		cache.Append(index + 1 - old_length);
+		MemSetT(cache.Get(old_length), 0, index + 1 - old_length);
+	}
+
+	CachedName *cn = cache.Get(index);
+	free(cn->name);
+	cn->name = strdup(name);
+	cn->key = key;
+	return cn->name;
+}
+
 
 const char *GetStringPtr(StringID string)
 {
@@ -1056,11 +1129,18 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 				if (wp->name != NULL) {
 					buff = strecpy(buff, wp->name, last);
 				} else {
-					int64 args_array[] = {wp->town->index, wp->town_cn + 1};
-					StringParameters tmp_params(args_array);
-					StringID str = ((wp->string_id == STR_SV_STNAME_BUOY) ? STR_FORMAT_BUOY_NAME : STR_FORMAT_WAYPOINT_NAME);
-					if (wp->town_cn != 0) str++;
-					buff = GetStringWithArgs(buff, str, &tmp_params, last);
+					uint64 key = (uint64)wp->string_id << 32 | (uint32)wp->town->index << 16 | wp->town_cn;
+					char buf[256];
+					const char *name = _keep_gender_data ? NULL : GetCachedName(NCT_WAYPOINT, wp->index, key);
+					if (name == NULL) {
+						int64 args_array[] = {wp->town->index, wp->town_cn + 1};
+						StringParameters tmp_params(args_array);
+						StringID str = ((wp->string_id == STR_SV_STNAME_BUOY) ? STR_FORMAT_BUOY_NAME : STR_FORMAT_WAYPOINT_NAME);
+						if (wp->town_cn != 0) str++;
+						GetStringWithArgs(buf, str, &tmp_params, lastof(buf));
+						name = _keep_gender_data ? buf : SetCachedName(NCT_WAYPOINT, wp->index, key, buf);
+					}
+					buff = strecpy(buff, name, last);
 				}
 				break;
 			}
@@ -1080,7 +1160,15 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 
 				if (st->name != NULL) {
 					buff = strecpy(buff, st->name, last);
-				} else {
+					break;
+				}
+
+				/* The industry providing the name comes from the station's creation, so it is part of the key too. */
+				uint64 key = (uint64)st->indtype << 48 | (uint64)st->town->index << 32 | st->string_id;
+				char buf[256];
+				/* With gender data the name is formatted differently; that variant is not cached. */
+				const char *name = _keep_gender_data ? NULL : GetCachedName(NCT_STATION, sid, key);
+				if (name == NULL) {
 					StringID str = st->string_id;
 					if (st->indtype != IT_INVALID) {
 						/* Special case where the industry provides the name for the station */
@@ -1096,8 +1184,10 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 
 					int64 args_array[] = {STR_TOWN_NAME, st->town->index, st->index};
 					StringParameters tmp_params(args_array);
-					buff = GetStringWithArgs(buff, str, &tmp_params, last);
+					GetStringWithArgs(buf, str, &tmp_params, lastof(buf));
+					name = _keep_gender_data ? buf : SetCachedName(NCT_STATION, sid, key, buf);
 				}
+				buff = strecpy(buff, name, last);
 				break;
 			}
 
@@ -1129,7 +1219,13 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 				if (t->name != NULL) {
 					buff = strecpy(buff, t->name, last);
 				} else {
-					buff = GetTownName(buff, t, last);
+					const char *name = GetCachedName(NCT_TOWN, t->index, t->townnameparts);
+					if (name == NULL) {
+						char buf[256];
+						GetTownName(buf, t, lastof(buf));
+						name = SetCachedName(NCT_TOWN, t->index, t->townnameparts, buf);
+					}
+					buff = strecpy(buff, name, last);
 				}
 				break;
 			}
@@ -1544,6 +1640,7 @@ bool ReadLanguagePack(const LanguageMetadata *lang)
 	_langpack_offs = langpack_offs;
 
 	_current_language = lang;
+	InvalidateNameCache();
 	_current_text_dir = (TextDirection)_current_language->text_dir;
 	const char *c_file = strrchr(_current_language->file, PATHSEPCHAR) + 1;
 	strecpy(_config_language_file, c_file, lastof(_config_language_file));
@@ -192,6 +192,7 @@ static inline uint64 GetDParam(uint n)
 extern TextDirection _current_text_dir; ///< Text direction of the currently selected language
 
 void InitializeLanguagePacks();
+void InvalidateNameCache();
 const char *GetCurrentLanguageIsoCode();
 
 int CDECL StringIDSorter(const StringID *a, const StringID *b);
@@ -678,6 +678,7 @@ SDTC_VAR(       network.last_port, SLE_UINT16, SLF_NOT_IN_SAVE | SLF_NO_NETWORK_
 #endif
 #ifdef ENABLE_NETWORK
 SDTC_BOOL(       network.no_http_content_downloads,        SLF_NOT_IN_SAVE | SLF_NO_NETWORK_SYNC, 0, false,                              STR_NULL, STR_NULL, NULL, 0, SL_MAX_VERSION),
+SDTC_BOOL(       network.io_thread,        SLF_NOT_IN_SAVE | SLF_NO_NETWORK_SYNC, SGF_NETWORK_ONLY, false,                              STR_NULL, STR_NULL, NULL, 0, SL_MAX_VERSION),
 #endif
 #ifdef __APPLE__
 SDTC_VAR(       gui.right_mouse_btn_emulation, SLE_UINT8, SLF_NOT_IN_SAVE | SLF_NO_NETWORK_SYNC, SGF_MULTISTRING, 0,       0, 2, 0, STR_CONFIG_SETTING_RIGHT_MOUSE_BTN_EMU, STR_CONFIG_SETTING_RIGHT_MOUSE_BTN_EMU_COMMAND, NULL, 0, SL_MAX_VERSION),
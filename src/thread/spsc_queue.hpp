@@ -0,0 +1,96 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file spsc_queue.hpp Queue for handing items from one thread to another without locking. */
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#if defined(_MSC_VER)
+#	include <windows.h>
+	/** Make sure all memory accesses before this point are done before any after it. */
+#	define MEMORY_FENCE() MemoryBarrier()
+#else
+	/** Make sure all memory accesses before this point are done before any after it. */
+#	define MEMORY_FENCE() __sync_synchronize()
+#endif
+
+/**
+ * Fixed size ring buffer that one thread can push to while another thread
+ * pops from it, without either of them taking a lock.
+ * Only one thread may push and only one thread may pop.
+ * @tparam T         The type of the items; should be cheap to copy.
+ * @tparam Tcapacity One more than the maximum number of items in the queue.
+ */
+template <typename T, uint Tcapacity>
+class SPSCQueue {
+	T items[Tcapacity];  ///< The ring of items.
+	volatile uint head;  ///< Index of the next item to pop; only written by the consumer.
+	volatile uint tail;  ///< Index of the next free slot; only written by the producer.
+
+public:
+	/** Create an empty queue. */
+	SPSCQueue() : head(0), tail(0) {}
+
+	/**
+	 * Add an item to the end of the queue; may only be called by the producer.
+	 * @param item The item to add.
+	 * @return False when the queue is full.
+	 */
+	bool Push(const T &item)
+	{
+		uint tail = this->tail;
+		uint next = (tail + 1) % Tcapacity;
+		if (next == this->head) return false;
+
+		this->items[tail] = item;
+		/* The item must be visible before the consumer may read it. */
+		MEMORY_FENCE();
+		this->tail = next;
+		return true;
+	}
+
+	/**
+	 * Take the item from the front of the queue; may only be called by the consumer.
+	 * @param item Where to store the item.
+	 * @return False when the queue is empty.
+	 */
+	bool Pop(T *item)
+	{
+		uint head = this->head;
+		if (head == this->tail) return false;
+
+		MEMORY_FENCE();
+		*item = this->items[head];
+		/* The item must be read before the producer may overwrite it. */
+		MEMORY_FENCE();
+		this->head = (head + 1) % Tcapacity;
+		return true;
+	}
+
+	/**
+	 * Check whether there are no items in the queue.
+	 * @return True when the queue is empty.
+	 */
+	bool IsEmpty() const
+	{
+		return this->head == this->tail;
+	}
+
+	/**
+	 * Check whether another item can be pushed; may only be called by the producer.
+	 * @return True when the queue is full.
+	 */
+	bool IsFull() const
+	{
+		return (this->tail + 1) % Tcapacity == this->head;
+	}
+};
+
+#endif /* SPSC_QUEUE_HPP */
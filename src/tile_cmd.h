@@ -148,7 +148,7 @@ struct TileTypeProcs {
 	GetTileTrackStatusProc *get_tile_track_status_proc; ///< Get available tracks and status of a tile
 	ClickTileProc *click_tile_proc;                ///< Called when tile is clicked
 	AnimateTileProc *animate_tile_proc;
-	TileLoopProc *tile_loop_proc;
+	TileLoopProc *tile_loop_proc;                  ///< Called periodically for every tile; \c NULL when tiles of the type need no periodic processing
 	ChangeTileOwnerProc *change_tile_owner_proc;
 	AddProducedCargoProc *add_produced_cargo_proc; ///< Adds produced cargo of the tile to cargo array supplied as parameter
 	VehicleEnterTileProc *vehicle_enter_tile_proc; ///< Called when a vehicle enters a tile
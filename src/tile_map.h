@@ -16,6 +16,21 @@
 #include "map_func.h"
 #include "core/bitmath_func.hpp"
 #include "settings_type.h"
+#include "pathfinder/water_regions.h"
+#include "water.h"
+#include "signal_func.h"
+
+void InvalidateStationAcceptance(TileIndex tile);
+
+/**
+ * Check whether tiles of a type can accept cargo.
+ * @param type The tile type.
+ * @return True when changing such a tile might change the acceptance of stations.
+ */
+static inline bool IsAcceptanceTileType(TileType type)
+{
+	return type == MP_HOUSE || type == MP_INDUSTRY || type == MP_OBJECT;
+}
 
 /**
  * Returns the height of a tile
@@ -48,6 +63,8 @@ static inline void SetTileHeight(TileIndex tile, uint height)
 {
 	assert(tile < MapSize());
 	assert(height <= MAX_TILE_HEIGHT);
+	/* The height is that of the north corner, which is shared with the tiles to the north. */
+	InvalidateFloodFrontier(tile, 2, 1);
 	SB(_m[tile].type_height, 0, 4, height);
 }
 
@@ -96,6 +113,11 @@ static inline void SetTileType(TileIndex tile, TileType type)
 	 * edges of the map. If _settings_game.construction.freeform_edges is true,
 	 * the upper edges of the map are also VOID tiles. */
 	assert((TileX(tile) == MapMaxX() || TileY(tile) == MapMaxY() || (_settings_game.construction.freeform_edges && (TileX(tile) == 0 || TileY(tile) == 0))) == (type == MP_VOID));
+	/* Only these tile types can be used by ships; the water regions need to know when they change. */
+	if (IsWaterRegionTileType(type) || IsWaterRegionTileType(GetTileType(tile))) InvalidateWaterRegion(tile);
+	InvalidateFloodFrontier(tile, 1, 1);
+	if (IsAcceptanceTileType(type) || IsAcceptanceTileType(GetTileType(tile))) InvalidateStationAcceptance(tile);
+	if (IsSignalSegmentTileType(type) || IsSignalSegmentTileType(GetTileType(tile))) InvalidateSignalSegments();
 	SB(_m[tile].type_height, 4, 4, type);
 }
 
@@ -162,6 +184,7 @@ static inline void SetTileOwner(TileIndex tile, Owner owner)
 	assert(!IsTileType(tile, MP_HOUSE));
 	assert(!IsTileType(tile, MP_INDUSTRY));
 
+	if (IsSignalSegmentTileType(GetTileType(tile))) InvalidateSignalSegments();
 	SB(_m[tile].m1, 0, 5, owner);
 }
 
@@ -602,11 +602,10 @@ static CallBackFunction MenuClickIndustry(int index)
 
 static void ToolbarVehicleClick(Window *w, VehicleType veh)
 {
-	const Vehicle *v;
 	int dis = ~0;
 
-	FOR_ALL_VEHICLES(v) {
-		if (v->type == veh && v->IsPrimaryVehicle()) ClrBit(dis, v->owner);
+	for (CompanyID c = COMPANY_FIRST; c < MAX_COMPANIES; c++) {
+		if (GetFirstCompanyVehicle(c, veh) != NULL) ClrBit(dis, c);
 	}
 	PopupMainCompanyToolbMenu(w, TBN_VEHICLESTART + veh, dis);
 }
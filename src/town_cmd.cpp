@@ -61,6 +61,9 @@ Town::~Town()
 {
 	free(this->name);
 
+	/* Another town may get our index, and thus the names of our stations. */
+	InvalidateNameCache();
+
 	if (CleaningPool()) return;
 
 	/* Delete town authority window
@@ -2313,6 +2316,8 @@ CommandCost CmdRenameTown(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 	if (flags & DC_EXEC) {
 		free(t->name);
 		t->name = reset ? NULL : strdup(text);
+		/* Names of stations and waypoints contain the name of their town. */
+		InvalidateNameCache();
 
 		t->UpdateVirtCoord();
 		InvalidateWindowData(WC_TOWN_DIRECTORY, 0, 1);
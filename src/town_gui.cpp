@@ -659,7 +659,6 @@ struct TownDirectoryWindow : public Window {
 private:
 	/* Runtime saved values */
 	static Listing last_sorting;
-	static const Town *last_town;
 
 	/* Constants for sorting towns */
 	static GUITownList::SortFunction * const sorter_funcs[];
@@ -683,31 +682,16 @@ private:
 			this->vscroll->SetCount(this->towns.Length()); // Update scrollbar as well.
 		}
 		/* Always sort the towns. */
-		this->last_town = NULL;
 		this->towns.Sort();
 	}
 
 	/** Sort by town name */
 	static int CDECL TownNameSorter(const Town * const *a, const Town * const *b)
 	{
-		static char buf_cache[64];
-		const Town *ta = *a;
-		const Town *tb = *b;
-		char buf[64];
-
-		SetDParam(0, ta->index);
-		GetString(buf, STR_TOWN_NAME, lastof(buf));
-
-		/* If 'b' is the same town as in the last round, use the cached value
-		 * We do this to speed stuff up ('b' is called with the same value a lot of
-		 * times after eachother) */
-		if (tb != last_town) {
-			last_town = tb;
-			SetDParam(0, tb->index);
-			GetString(buf_cache, STR_TOWN_NAME, lastof(buf_cache));
-		}
+		/* Cached names, to spare many GetString() calls. */
+		static SortNameCache names;
 
-		return strnatcmp(buf, buf_cache); // Sort by name (natural sorting).
+		return strnatcmp(names.Get((*a)->index, STR_TOWN_NAME), names.Get((*b)->index, STR_TOWN_NAME)); // Sort by name (natural sorting).
 	}
 
 	/** Sort by population */
@@ -890,7 +874,6 @@ public:
 };
 
 Listing TownDirectoryWindow::last_sorting = {false, 0};
-const Town *TownDirectoryWindow::last_town = NULL;
 
 /* Available town directory sorting functions */
 GUITownList::SortFunction * const TownDirectoryWindow::sorter_funcs[] = {
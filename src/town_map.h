@@ -74,6 +74,7 @@ static inline void SetHouseType(TileIndex t, HouseID house_id)
 	assert(IsTileType(t, MP_HOUSE));
 	_m[t].m4 = GB(house_id, 0, 8);
 	SB(_m[t].m3, 6, 1, GB(house_id, 8, 1));
+	InvalidateStationAcceptance(t);
 }
 
 /**
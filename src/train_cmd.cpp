@@ -899,11 +899,13 @@ static void NormaliseSubtypes(Train *chain)
 		assert(chain->IsEngine());
 		chain->SetFrontEngine();
 	}
+	UpdateCompanyVehicleList(chain);
 
 	/* Now clear the bits for the rest of the chain */
 	for (Train *t = chain->Next(); t != NULL; t = t->Next()) {
 		t->ClearFreeWagon();
 		t->ClearFrontEngine();
+		UpdateCompanyVehicleList(t);
 	}
 }
 
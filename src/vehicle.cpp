@@ -584,12 +584,78 @@ void ResetVehicleColourMap()
 typedef SmallMap<Vehicle *, bool, 4> AutoreplaceMap;
 static AutoreplaceMap _vehicles_to_autoreplace;
 
+/**
+ * The primary vehicles of each company, by vehicle type.
+ * The order differs between a server and clients that joined later,
+ * so it must not influence the game state.
+ */
+static Vehicle *_company_vehicles[MAX_COMPANIES][VEH_COMPANY_END];
+
+/**
+ * Remove a vehicle from the list of primary vehicles it is in, if any.
+ * @param v The vehicle to remove.
+ */
+static void RemoveCompanyVehicle(Vehicle *v)
+{
+	if (v->prev_company_vehicle == NULL) return;
+
+	*v->prev_company_vehicle = v->next_company_vehicle;
+	if (v->next_company_vehicle != NULL) v->next_company_vehicle->prev_company_vehicle = v->prev_company_vehicle;
+	v->next_company_vehicle = NULL;
+	v->prev_company_vehicle = NULL;
+}
+
+/**
+ * Put a vehicle in the right list of primary vehicles after it has been
+ * built, changed owner or became or stopped being a primary vehicle.
+ * @param v The vehicle to update.
+ */
+void UpdateCompanyVehicleList(Vehicle *v)
+{
+	RemoveCompanyVehicle(v);
+
+	if (!v->IsPrimaryVehicle() || v->owner >= MAX_COMPANIES || !IsCompanyBuildableVehicleType(v)) return;
+
+	Vehicle **head = &_company_vehicles[v->owner][v->type];
+	v->next_company_vehicle = *head;
+	v->prev_company_vehicle = head;
+	if (*head != NULL) (*head)->prev_company_vehicle = &v->next_company_vehicle;
+	*head = v;
+}
+
+/** Build the lists of primary vehicles from scratch, e.g. after loading a game. */
+void RebuildCompanyVehicleLists()
+{
+	memset(_company_vehicles, 0, sizeof(_company_vehicles));
+
+	Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		v->next_company_vehicle = NULL;
+		v->prev_company_vehicle = NULL;
+		UpdateCompanyVehicleList(v);
+	}
+}
+
+/**
+ * Get the first primary vehicle of a company of a given type.
+ * @param company The company owning the vehicles.
+ * @param type    The type of the vehicles.
+ * @return The first vehicle, or NULL if there are none or the company or type is invalid.
+ */
+Vehicle *GetFirstCompanyVehicle(CompanyID company, VehicleType type)
+{
+	/* Vehicle list identifiers can come from the network, so do not trust them. */
+	if (company >= MAX_COMPANIES || type >= VEH_COMPANY_END) return NULL;
+	return _company_vehicles[company][type];
+}
+
 void InitializeVehicles()
 {
 	_age_cargo_skip_counter = 1;
 
 	_vehicles_to_autoreplace.Reset();
 	ResetVehiclePosHash();
+	memset(_company_vehicles, 0, sizeof(_company_vehicles));
 }
 
 uint CountVehiclesInChain(const Vehicle *v)
@@ -606,11 +672,11 @@ uint CountVehiclesInChain(const Vehicle *v)
  */
 void CountCompanyVehicles(CompanyID cid, uint counts[4])
 {
-	for (uint i = 0; i < 4; i++) counts[i] = 0;
+	for (uint i = 0; i < 4; i++) {
+		counts[i] = 0;
 
-	const Vehicle *v;
-	FOR_ALL_VEHICLES(v) {
-		if (v->owner == cid && v->IsPrimaryVehicle()) counts[v->type]++;
+		const Vehicle *v;
+		FOR_ALL_COMPANY_VEHICLES(v, cid, (VehicleType)i) counts[i]++;
 	}
 }
 
@@ -669,6 +735,8 @@ void Vehicle::PreDestructor()
 {
 	if (CleaningPool()) return;
 
+	RemoveCompanyVehicle(this);
+
 	if (Station::IsValidID(this->last_station_visited)) {
 		Station::Get(this->last_station_visited)->loading_vehicles.remove(this);
 
@@ -805,6 +873,8 @@ void CallVehicleTicks()
 
 	RunVehicleDayProc();
 
+	UpdateSoundViewportAreas();
+
 	Station *st;
 	FOR_ALL_STATIONS(st) LoadUnloadStation(st);
 
@@ -833,10 +903,16 @@ void CallVehicleTicks()
 
 				v->motion_counter += v->cur_speed;
 				/* Play a running sound if the motion counter passes 256 (Do we not skip sounds?) */
-				if (GB(v->motion_counter, 0, 8) < v->cur_speed) PlayVehicleSound(v, VSE_RUNNING);
-
+				bool running_sound = GB(v->motion_counter, 0, 8) < v->cur_speed;
 				/* Play an alterate running sound every 16 ticks */
-				if (GB(v->tick_counter, 0, 4) == 0) PlayVehicleSound(v, v->cur_speed > 0 ? VSE_RUNNING_16 : VSE_STOPPED_16);
+				bool tick_sound = GB(v->tick_counter, 0, 4) == 0;
+				if (!running_sound && !tick_sound) continue;
+
+				/* Nobody can hear it, so skip resolving the sound callback. */
+				if (!IsVehicleAudible(v)) continue;
+
+				if (running_sound) PlayVehicleSound(v, VSE_RUNNING);
+				if (tick_sound) PlayVehicleSound(v, v->cur_speed > 0 ? VSE_RUNNING_16 : VSE_STOPPED_16);
 		}
 	}
 
@@ -163,6 +163,9 @@ public:
 	Vehicle **prev_new_hash;            ///< NOSAVE: Previous vehicle in the tile location hash.
 	Vehicle **old_new_hash;             ///< NOSAVE: Cache of the current hash chain.
 
+	Vehicle *next_company_vehicle;      ///< NOSAVE: Next primary vehicle of the same company and type.
+	Vehicle **prev_company_vehicle;     ///< NOSAVE: Previous primary vehicle of the same company and type, or NULL if not in that list.
+
 	SpriteID colourmap;                 ///< NOSAVE: cached colour mapping
 
 	/* Related to age and service time */
@@ -814,6 +817,16 @@ public:
  */
 #define FOR_ALL_VEHICLES(var) FOR_ALL_VEHICLES_FROM(var, 0)
 
+Vehicle *GetFirstCompanyVehicle(CompanyID company, VehicleType type);
+
+/**
+ * Iterate over the primary vehicles of a company of a given type.
+ * @param var     The variable used to iterate over.
+ * @param company The company owning the vehicles.
+ * @param type    The type of the vehicles; must be buildable by companies.
+ */
+#define FOR_ALL_COMPANY_VEHICLES(var, company, type) for (var = GetFirstCompanyVehicle(company, type); var != NULL; var = var->next_company_vehicle)
+
 /**
  * Class defining several overloaded accessors so we don't
  * have to cast vehicle types that often
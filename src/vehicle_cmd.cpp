@@ -142,6 +142,7 @@ CommandCost CmdBuildVehicle(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 		}
 
 		Company::Get(_current_company)->num_engines[eid]++;
+		UpdateCompanyVehicleList(v);
 
 		if (v->IsPrimaryVehicle()) OrderBackup::Restore(v, p2);
 	}
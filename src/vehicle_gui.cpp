@@ -170,15 +170,9 @@ DropDownList *BaseVehicleListWindow::BuildActionDropdownList(bool show_autorepla
 	return list;
 }
 
-/* cached values for VehicleNameSorter to spare many GetString() calls */
-static const Vehicle *_last_vehicle[2] = { NULL, NULL };
-
 void BaseVehicleListWindow::SortVehicleList()
 {
-	if (this->vehicles.Sort()) return;
-
-	/* invalidate cached values for name sorter - vehicle names could change */
-	_last_vehicle[0] = _last_vehicle[1] = NULL;
+	this->vehicles.Sort();
 }
 
 void DepotSortList(VehicleList *list)
@@ -991,21 +985,10 @@ static int CDECL VehicleNumberSorter(const Vehicle * const *a, const Vehicle * c
 /** Sort vehicles by their name */
 static int CDECL VehicleNameSorter(const Vehicle * const *a, const Vehicle * const *b)
 {
-	static char last_name[2][64];
-
-	if (*a != _last_vehicle[0]) {
-		_last_vehicle[0] = *a;
-		SetDParam(0, (*a)->index);
-		GetString(last_name[0], STR_VEHICLE_NAME, lastof(last_name[0]));
-	}
-
-	if (*b != _last_vehicle[1]) {
-		_last_vehicle[1] = *b;
-		SetDParam(0, (*b)->index);
-		GetString(last_name[1], STR_VEHICLE_NAME, lastof(last_name[1]));
-	}
+	/* Cached names, to spare many GetString() calls. */
+	static SortNameCache names;
 
-	int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
+	int r = strnatcmp(names.Get((*a)->index, STR_VEHICLE_NAME), names.Get((*b)->index, STR_VEHICLE_NAME)); // Sort by name (natural sorting).
 	return (r != 0) ? r : VehicleNumberSorter(a, b);
 }
 
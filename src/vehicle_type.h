@@ -23,7 +23,10 @@ enum VehicleType {
 	VEH_ROAD,           ///< Road vehicle type.
 	VEH_SHIP,           ///< %Ship vehicle type.
 	VEH_AIRCRAFT,       ///< %Aircraft vehicle type.
-	VEH_EFFECT,         ///< Effect vehicle type (smoke, explosions, sparks, bubbles)
+
+	VEH_COMPANY_END,    ///< Last company-ownable type.
+
+	VEH_EFFECT = VEH_COMPANY_END, ///< Effect vehicle type (smoke, explosions, sparks, bubbles)
 	VEH_DISASTER,       ///< Disaster vehicle type.
 	VEH_END,
 	VEH_INVALID = 0xFF, ///< Non-existing type of vehicle.
@@ -12,6 +12,7 @@
 #include "stdafx.h"
 #include "train.h"
 #include "vehiclelist.h"
+#include "order_base.h"
 
 /**
  * Pack a VehicleListIdentifier in a single uint32.
@@ -99,6 +100,56 @@ void BuildDepotVehicleList(VehicleType type, TileIndex tile, VehicleList *engine
 	if (wagons != NULL && wagons != engines) wagons->Compact();
 }
 
+/**
+ * Add the vehicles of all order lists with a matching order to a vehicle list.
+ * Only the order lists are checked, so vehicles without orders and all the
+ * wagons, articulated parts and such do not cost anything.
+ * @param list  The list to add the vehicles to.
+ * @param vtype The type of the vehicles to add.
+ * @param match Function checking whether an order is a matching one.
+ * @param index The destination the orders have to go to.
+ */
+static void AddVehiclesWithOrderTo(VehicleList *list, VehicleType vtype, bool (*match)(const Order *order, uint32 index), uint32 index)
+{
+	const OrderList *orderlist;
+	FOR_ALL_ORDER_LISTS(orderlist) {
+		const Vehicle *first = orderlist->GetFirstSharedVehicle();
+		if (first == NULL || first->type != vtype) continue;
+
+		const Order *order;
+		for (order = orderlist->GetFirstOrder(); order != NULL; order = order->next) {
+			if (match(order, index)) break;
+		}
+		if (order == NULL) continue;
+
+		for (const Vehicle *v = first; v != NULL; v = v->NextShared()) {
+			if (v->IsPrimaryVehicle()) *list->Append() = v;
+		}
+	}
+}
+
+/**
+ * Check whether an order makes vehicles stop at a station or waypoint.
+ * @param order The order to check.
+ * @param index The station or waypoint.
+ * @return True if the order goes to the station.
+ */
+static bool IsOrderToStation(const Order *order, uint32 index)
+{
+	return (order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT)) && order->GetDestination() == index;
+}
+
+/**
+ * Check whether an order sends vehicles to a specific depot.
+ * @param order The order to check.
+ * @param index The depot.
+ * @return True if the order goes to the depot.
+ */
+static bool IsOrderToDepot(const Order *order, uint32 index)
+{
+	return order->IsType(OT_GOTO_DEPOT) && !(order->GetDepotActionType() & ODATFB_NEAREST_DEPOT) && order->GetDestination() == index;
+}
+
 /**
  * Generate a list of vehicles based on window type.
  * @param list Pointer to list to add vehicles to
@@ -113,19 +164,7 @@ bool GenerateVehicleSortList(VehicleList *list, const VehicleListIdentifier &vli
 
 	switch (vli.type) {
 		case VL_STATION_LIST:
-			FOR_ALL_VEHICLES(v) {
-				if (v->type == vli.vtype && v->IsPrimaryVehicle()) {
-					const Order *order;
-
-					FOR_VEHICLE_ORDERS(v, order) {
-						if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT))
-								&& order->GetDestination() == vli.index) {
-							*list->Append() = v;
-							break;
-						}
-					}
-				}
-			}
+			AddVehiclesWithOrderTo(list, vli.vtype, &IsOrderToStation, vli.index);
 			break;
 
 		case VL_SHARED_ORDERS:
@@ -140,37 +179,21 @@ bool GenerateVehicleSortList(VehicleList *list, const VehicleListIdentifier &vli
 
 		case VL_GROUP_LIST:
 			if (vli.index != ALL_GROUP) {
-				FOR_ALL_VEHICLES(v) {
-					if (v->type == vli.vtype && v->IsPrimaryVehicle() &&
-							v->owner == vli.company && v->group_id == vli.index) {
-						*list->Append() = v;
-					}
+				FOR_ALL_COMPANY_VEHICLES(v, vli.company, vli.vtype) {
+					if (v->group_id == vli.index) *list->Append() = v;
 				}
 				break;
 			}
 			/* FALL THROUGH */
 
 		case VL_STANDARD:
-			FOR_ALL_VEHICLES(v) {
-				if (v->type == vli.vtype && v->owner == vli.company && v->IsPrimaryVehicle()) {
-					*list->Append() = v;
-				}
+			FOR_ALL_COMPANY_VEHICLES(v, vli.company, vli.vtype) {
+				*list->Append() = v;
 			}
 			break;
 
 		case VL_DEPOT_LIST:
-			FOR_ALL_VEHICLES(v) {
-				if (v->type == vli.vtype && v->IsPrimaryVehicle()) {
-					const Order *order;
-
-					FOR_VEHICLE_ORDERS(v, order) {
-						if (order->IsType(OT_GOTO_DEPOT) && !(order->GetDepotActionType() & ODATFB_NEAREST_DEPOT) && order->GetDestination() == vli.index) {
-							*list->Append() = v;
-							break;
-						}
-					}
-				}
-			}
+			AddVehiclesWithOrderTo(list, vli.vtype, &IsOrderToDepot, vli.index);
 			break;
 
 		default: return false;
@@ -45,6 +45,7 @@
 #include "window_func.h"
 #include "tilehighlight_func.h"
 #include "window_gui.h"
+#include "smallmap_gui.h"
 
 #include "table/strings.h"
 
@@ -1644,6 +1645,8 @@ void MarkAllViewportsDirty(int left, int top, int right, int bottom)
  */
 void MarkTileDirtyByTile(TileIndex tile)
 {
+	MarkSmallMapTileDirty(tile);
+
 	Point pt = RemapCoords(TileX(tile) * TILE_SIZE, TileY(tile) * TILE_SIZE, GetTileZ(tile));
 	MarkAllViewportsDirty(
 		pt.x - 31,
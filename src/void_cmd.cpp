@@ -45,11 +45,6 @@ static void GetTileDesc_Void(TileIndex tile, TileDesc *td)
 	td->owner[0] = OWNER_NONE;
 }
 
-static void TileLoop_Void(TileIndex tile)
-{
-	/* not used */
-}
-
 static void ChangeTileOwner_Void(TileIndex tile, Owner old_owner, Owner new_owner)
 {
 	/* not used */
@@ -74,7 +69,7 @@ extern const TileTypeProcs _tile_type_void_procs = {
 	GetTileTrackStatus_Void,  // get_tile_track_status_proc
 	NULL,                     // click_tile_proc
 	NULL,                     // animate_tile_proc
-	TileLoop_Void,            // tile_loop_clear
+	NULL,                     // tile_loop_clear
 	ChangeTileOwner_Void,     // change_tile_owner_clear
 	NULL,                     // add_produced_cargo_proc
 	NULL,                     // vehicle_enter_tile_proc
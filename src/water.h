@@ -29,6 +29,8 @@ enum FloodingBehaviour {
 FloodingBehaviour GetFloodingBehaviour(TileIndex tile);
 
 void TileLoop_Water(TileIndex tile);
+void InitializeFloodFrontier();
+void InvalidateFloodFrontier(TileIndex tile, uint before, uint after);
 bool FloodHalftile(TileIndex t);
 void DoFloodTile(TileIndex target);
 
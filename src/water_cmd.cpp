@@ -1051,6 +1051,40 @@ static void DoDryUp(TileIndex tile)
 	cur_company.Restore();
 }
 
+static uint32 *_flood_frontier = NULL; ///< Bit per tile; set when the tile might be able to flood one of its neighbours.
+
+/** Put all tiles of the (newly allocated) map on the flooding frontier. */
+void InitializeFloodFrontier()
+{
+	free(_flood_frontier);
+
+	uint words = (MapSize() + 31) / 32;
+	_flood_frontier = MallocT<uint32>(words);
+	MemSetT(_flood_frontier, 0xFF, words);
+}
+
+/**
+ * Put the tiles around a changed tile back on the flooding frontier.
+ * @param tile   The changed tile.
+ * @param before Number of tiles before the tile, along both axes, that are affected by the change.
+ * @param after  Number of tiles after the tile, along both axes, that are affected by the change.
+ */
+void InvalidateFloodFrontier(TileIndex tile, uint before, uint after)
+{
+	if (_flood_frontier == NULL) return;
+
+	uint x1 = TileX(tile) > before ? TileX(tile) - before : 0;
+	uint y1 = TileY(tile) > before ? TileY(tile) - before : 0;
+	uint x2 = min(TileX(tile) + after, MapMaxX());
+	uint y2 = min(TileY(tile) + after, MapMaxY());
+
+	for (uint y = y1; y <= y2; y++) {
+		for (TileIndex t = TileXY(x1, y); t <= TileXY(x2, y); t++) {
+			SetBit(_flood_frontier[t / 32], t % 32);
+		}
+	}
+}
+
 /**
  * Let a water tile floods its diagonal adjoining tiles
  * called from tunnelbridge_cmd, and by TileLoop_Industry() and TileLoop_Track()
@@ -1060,7 +1094,14 @@ static void DoDryUp(TileIndex tile)
 void TileLoop_Water(TileIndex tile)
 {
 	switch (GetFloodingBehaviour(tile)) {
-		case FLOOD_ACTIVE:
+		case FLOOD_ACTIVE: {
+			/* None of the neighbours could be flooded the last time, and
+			 * the types and heights of the tiles around did not change. */
+			if (!HasBit(_flood_frontier[tile / 32], tile % 32)) break;
+
+			/* Whether none of the neighbours can be flooded until the
+			 * type or the height of one of the tiles around changes. */
+			bool settled = true;
 			for (Direction dir = DIR_BEGIN; dir < DIR_END; dir++) {
 				TileIndex dest = AddTileIndexDiffCWrap(tile, TileIndexDiffCByDir(dir));
 				if (dest == INVALID_TILE) continue;
@@ -1069,13 +1110,21 @@ void TileLoop_Water(TileIndex tile)
 
 				uint z_dest;
 				Slope slope_dest = GetFoundationSlope(dest, &z_dest) & ~SLOPE_HALFTILE_MASK & ~SLOPE_STEEP;
-				if (z_dest > 0) continue;
+				if (z_dest > 0) {
+					/* Foundations can be removed without changing the type of the tile. */
+					if (GetTileZ(dest) == 0) settled = false;
+					continue;
+				}
 
+				settled = false;
 				if (!HasBit(_flood_from_dirs[slope_dest], ReverseDir(dir))) continue;
 
 				DoFloodTile(dest);
 			}
+
+			if (settled) ClrBit(_flood_frontier[tile / 32], tile % 32);
 			break;
+		}
 
 		case FLOOD_DRYUP: {
 			Slope slope_here = GetFoundationSlope(tile, NULL) & ~SLOPE_HALFTILE_MASK & ~SLOPE_STEEP;
@@ -42,6 +42,50 @@ Window *_z_front_window = NULL;
 /** List of windows opened at the screen sorted from the back. */
 Window *_z_back_window  = NULL;
 
+/** Number of buckets of #_window_index; every window class has a bucket of its own. */
+static const uint WINDOW_INDEX_SIZE = 128;
+/** Open windows by class, oldest first, so finding windows does not need to go over all of them. */
+static Window *_window_index[WINDOW_INDEX_SIZE];
+/** Windows to mark dirty before the next redraw. */
+static SmallVector<Window *, 16> _dirty_scheduled_windows;
+
+/**
+ * Iterate over the open windows of a class.
+ * Closing windows while iterating is allowed, as closed windows keep pointing into the index.
+ * @param w   The window to iterate with.
+ * @param cls The window class.
+ */
+#define FOR_ALL_WINDOWS_OF_CLASS(w, cls) for (w = _window_index[(cls) % WINDOW_INDEX_SIZE]; w != NULL; w = w->index_next) if (w->window_class == (cls))
+
+/**
+ * Add a window to the window index.
+ * @param w The window, with its class set.
+ */
+static void AddWindowToIndex(Window *w)
+{
+	w->indexed_class = w->window_class;
+	w->index_next = NULL;
+
+	Window **last = &_window_index[w->indexed_class % WINDOW_INDEX_SIZE];
+	while (*last != NULL) last = &(*last)->index_next;
+	*last = w;
+}
+
+/**
+ * Remove a window from the window index, if it is in there.
+ * The window keeps its #Window::index_next, so iterations that are at this window can continue.
+ * @param w The window.
+ */
+static void RemoveWindowFromIndex(Window *w)
+{
+	for (Window **iter = &_window_index[w->indexed_class % WINDOW_INDEX_SIZE]; *iter != NULL; iter = &(*iter)->index_next) {
+		if (*iter == w) {
+			*iter = w->index_next;
+			return;
+		}
+	}
+}
+
 /*
  * Window that currently has focus. - The main purpose is to generate
  * #FocusLost events, not to give next window in z-order focus when a
@@ -564,6 +608,29 @@ void Window::SetDirty() const
 	SetDirtyBlocks(this->left, this->top, this->left + this->width, this->top + this->height);
 }
 
+/**
+ * Mark entire window as dirty (in need of re-paint) just before the next redraw.
+ * Game logic may invalidate the same window very often in a single tick; this
+ * way the window is only marked dirty once.
+ */
+void Window::ScheduleSetDirty()
+{
+	if (this->dirty_scheduled) return;
+
+	this->dirty_scheduled = true;
+	*_dirty_scheduled_windows.Append() = this;
+}
+
+/** Mark the windows with a scheduled #Window::ScheduleSetDirty dirty. */
+static void ProcessScheduledSetDirty()
+{
+	for (Window **iter = _dirty_scheduled_windows.Begin(); iter != _dirty_scheduled_windows.End(); iter++) {
+		(*iter)->dirty_scheduled = false;
+		(*iter)->SetDirty();
+	}
+	_dirty_scheduled_windows.Clear();
+}
+
 /**
  * Re-initialize a window, and optionally change its size.
  * @param rx Horizontal resize of the window.
@@ -679,6 +746,8 @@ Window::~Window()
 	if (this->viewport != NULL) DeleteWindowViewport(this);
 
 	this->SetDirty();
+	if (this->dirty_scheduled) _dirty_scheduled_windows.Erase(_dirty_scheduled_windows.Find(this));
+	RemoveWindowFromIndex(this);
 
 	free(this->nested_array); // Contents is released through deletion of #nested_root.
 	delete this->nested_root;
@@ -694,12 +763,22 @@ Window::~Window()
  */
 Window *FindWindowById(WindowClass cls, WindowNumber number)
 {
+	Window *found = NULL;
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) return w;
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
+		if (w->window_number != number) continue;
+		if (found != NULL) {
+			/* More than one match; return the one furthest back, like the z-order walk always did. */
+			Window *v;
+			FOR_ALL_WINDOWS_FROM_BACK(v) {
+				if (v->window_class == cls && v->window_number == number) return v;
+			}
+			NOT_REACHED();
+		}
+		found = w;
 	}
 
-	return NULL;
+	return found;
 }
 
 /**
@@ -710,12 +789,21 @@ Window *FindWindowById(WindowClass cls, WindowNumber number)
  */
 Window *FindWindowByClass(WindowClass cls)
 {
+	Window *found = NULL;
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) return w;
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
+		if (found != NULL) {
+			/* More than one match; return the one furthest back, like the z-order walk always did. */
+			Window *v;
+			FOR_ALL_WINDOWS_FROM_BACK(v) {
+				if (v->window_class == cls) return v;
+			}
+			NOT_REACHED();
+		}
+		found = w;
 	}
 
-	return NULL;
+	return found;
 }
 
 /**
@@ -745,11 +833,9 @@ restart_search:
 	/* When we find the window to delete, we need to restart the search
 	 * as deleting this window could cascade in deleting (many) others
 	 * anywhere in the z-array */
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) {
-			delete w;
-			goto restart_search;
-		}
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
+		delete w;
+		goto restart_search;
 	}
 }
 
@@ -968,6 +1054,9 @@ void Window::InitializeData(const WindowDesc *desc, WindowNumber window_number)
 		}
 		_z_front_window = this;
 	}
+
+	/* Only index the window now it is in the z-ordering, so finding windows gives the same result as walking that. */
+	AddWindowToIndex(this);
 }
 
 /**
@@ -1343,6 +1432,8 @@ void InitWindowSystem()
 
 	_z_back_window = NULL;
 	_z_front_window = NULL;
+	MemSetT(_window_index, 0, WINDOW_INDEX_SIZE);
+	_dirty_scheduled_windows.Clear();
 	_focused_window = NULL;
 	_mouseover_last_w = NULL;
 	_last_scroll_window = NULL;
@@ -1368,6 +1459,7 @@ void UnInitWindowSystem()
 
 	_z_front_window = NULL;
 	_z_back_window = NULL;
+	MemSetT(_window_index, 0, WINDOW_INDEX_SIZE);
 }
 
 /**
@@ -2429,6 +2521,7 @@ void UpdateWindows()
 		}
 	}
 
+	ProcessScheduledSetDirty();
 	DrawDirtyBlocks();
 
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
@@ -2447,9 +2540,9 @@ void UpdateWindows()
  */
 void SetWindowDirty(WindowClass cls, WindowNumber number)
 {
-	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) w->SetDirty();
+	Window *w;
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
+		if (w->window_number == number) w->ScheduleSetDirty();
 	}
 }
 
@@ -2462,8 +2555,9 @@ void SetWindowDirty(WindowClass cls, WindowNumber number)
 void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_index)
 {
 	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) {
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
+		/* No need to bother when the whole window is going to be redrawn anyway. */
+		if (w->window_number == number && !w->dirty_scheduled) {
 			w->SetWidgetDirty(widget_index);
 		}
 	}
@@ -2476,9 +2570,7 @@ void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_inde
 void SetWindowClassesDirty(WindowClass cls)
 {
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) w->SetDirty();
-	}
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) w->ScheduleSetDirty();
 }
 
 /**
@@ -2510,8 +2602,8 @@ void SetWindowClassesDirty(WindowClass cls)
 void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool gui_scope)
 {
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) {
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
+		if (w->window_number == number) {
 			w->InvalidateData(data, gui_scope);
 		}
 	}
@@ -2529,10 +2621,8 @@ void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
 {
 	Window *w;
 
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) {
-			w->InvalidateData(data, gui_scope);
-		}
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
+		w->InvalidateData(data, gui_scope);
 	}
 }
 
@@ -276,6 +276,9 @@ public:
 	Window *parent;                  ///< Parent window.
 	Window *z_front;                 ///< The window in front of us in z-order.
 	Window *z_back;                  ///< The window behind us in z-order.
+	Window *index_next;              ///< The next window in the same bucket of the window index; kept when the window is closed.
+	WindowClass indexed_class;       ///< The class the window is filed under in the window index.
+	bool dirty_scheduled;            ///< The window is to be marked dirty before the next redraw.
 
 	template <class NWID>
 	inline const NWID *GetWidget(uint widnum) const;
@@ -421,6 +424,7 @@ public:
 	void DeleteChildWindows(WindowClass wc = WC_INVALID) const;
 
 	void SetDirty() const;
+	void ScheduleSetDirty();
 	void ReInit(int rx = 0, int ry = 0);
 
 	/** Is window shaded currently? */
@@ -438,10 +442,12 @@ public:
 	 */
 	void InvalidateData(int data = 0, bool gui_scope = true)
 	{
-		this->SetDirty();
+		this->ScheduleSetDirty();
 		if (!gui_scope) {
-			/* Schedule GUI-scope invalidation for next redraw. */
-			*this->scheduled_invalidation_data.Append() = data;
+			/* Schedule GUI-scope invalidation for next redraw; the same
+			 * invalidation many times in a row only needs doing once. */
+			uint n = this->scheduled_invalidation_data.Length();
+			if (n == 0 || this->scheduled_invalidation_data[n - 1] != data) *this->scheduled_invalidation_data.Append() = data;
 		}
 		this->OnInvalidateData(data, gui_scope);
 	}